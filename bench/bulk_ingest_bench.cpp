@@ -0,0 +1,73 @@
+// bench/bulk_ingest_bench.cpp
+// Ingest throughput of TaskManager::addTasks for batch sizes 1 to 10k,
+// against one addTask call per task, including the SQLite commit.
+// No nodes are registered, so every task ends in the ready queue and the
+// numbers cover id allocation, indexing, scheduling and persistence only.
+//
+// Usage: bulk_ingest_bench [tasks per run] [database file]
+#include "../include/TaskManager.h"
+#include "../include/FIFOScheduler.h"
+#include "../include/Node.h"
+#include "../include/DatabaseManager.h"
+#include "../include/loggingservice.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// batchSize 0 means one addTask call per task
+double run(const std::string& dbPath, int taskCount, size_t batchSize) {
+    std::remove(dbPath.c_str());
+    double rate = -1;
+    {
+        TaskManager manager(std::make_unique<FIFOScheduler>(), dbPath);
+        if (!manager.initialize()) {
+            return -1;
+        }
+
+        std::vector<TaskSpec> batch;
+        auto start = Clock::now();
+        for (int i = 0; i < taskCount; ++i) {
+            if (batchSize == 0) {
+                manager.addTask("bench", 1);
+                continue;
+            }
+            batch.push_back(TaskSpec{"bench", 1, nullptr});
+            if (batch.size() == batchSize || i + 1 == taskCount) {
+                manager.addTasks(batch);
+                batch.clear();
+            }
+        }
+        manager.getDbManager()->flush();
+        rate = taskCount / std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    std::remove(dbPath.c_str());
+    std::remove((dbPath + "-wal").c_str());
+    std::remove((dbPath + "-shm").c_str());
+    return rate;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int taskCount = argc > 1 ? std::stoi(argv[1]) : 20000;
+    std::string dbPath = argc > 2 ? argv[2] : "bulk_ingest_bench.db";
+
+    LoggingService::getInstance()->setMinLogLevel(LogLevel::WARNING);
+
+    std::vector<std::pair<std::string, double>> results;
+    results.emplace_back("addTask", run(dbPath, taskCount, 0));
+    for (size_t batchSize : {size_t(1), size_t(10), size_t(100), size_t(1000), size_t(10000)}) {
+        results.emplace_back("addTasks x" + std::to_string(batchSize), run(dbPath, taskCount, batchSize));
+    }
+
+    std::printf("tasks per run: %d\n", taskCount);
+    for (const auto& result : results) {
+        std::printf("%-18s %12.0f tasks/s\n", result.first.c_str(), result.second);
+    }
+    return 0;
+}
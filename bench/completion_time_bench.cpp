@@ -0,0 +1,121 @@
+// bench/completion_time_bench.cpp
+// Mean and p99 completion time of a mixed batch (mostly short tasks, some
+// long ones) submitted at once through addTasks, for each placement policy
+// with the nodes' queues in arrival order and in shortest-job-first order.
+// Completion time is measured from submission to the end of the task.
+//
+// Tasks run a CallableExecutor that sleeps `duration` time units, so the
+// schedulers see the declared durations while the run stays short.
+//
+// Usage: completion_time_bench [nodes] [tasks] [ms per duration unit] [work stealing 0|1]
+#include "../include/TaskManager.h"
+#include "../include/FIFOScheduler.h"
+#include "../include/Node.h"
+#include "../include/DatabaseManager.h"
+#include "../include/TaskExecutor.h"
+#include "../include/loggingservice.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double meanMs;
+    double p99Ms;
+};
+
+Result run(SchedulerType type, bool sjf, int nodeCount, const std::vector<int>& durations,
+           int unitMs, bool stealing) {
+    TaskManager manager(std::make_unique<FIFOScheduler>(), ":memory:");
+    if (!manager.initialize()) {
+        return Result{-1, -1};
+    }
+    manager.setWorkStealing(stealing);
+    manager.setScheduler(type);
+    manager.setShortestJobFirst(sjf);
+    for (int i = 0; i < nodeCount; ++i) {
+        manager.addNode();
+    }
+
+    std::vector<Clock::time_point> finished(durations.size());
+    std::atomic<size_t> done(0);
+    std::vector<TaskSpec> specs;
+    for (size_t i = 0; i < durations.size(); ++i) {
+        int sleepMs = durations[i] * unitMs;
+        auto executor = std::make_shared<CallableExecutor>([&finished, &done, i, sleepMs] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(sleepMs));
+            finished[i] = Clock::now();
+            done++;
+            return true;
+        });
+        specs.push_back(TaskSpec{"bench", durations[i], executor});
+    }
+
+    auto submitted = Clock::now();
+    manager.addTasks(specs);
+    while (done.load() < durations.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    std::vector<double> completion;
+    for (const auto& end : finished) {
+        completion.push_back(std::chrono::duration<double, std::milli>(end - submitted).count());
+    }
+    std::sort(completion.begin(), completion.end());
+    double total = 0;
+    for (double ms : completion) total += ms;
+    manager.getDbManager()->flush();
+    return Result{total / completion.size(), completion[completion.size() * 99 / 100]};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int nodeCount = argc > 1 ? std::stoi(argv[1]) : 4;
+    int taskCount = argc > 2 ? std::stoi(argv[2]) : 100;
+    int unitMs = argc > 3 ? std::stoi(argv[3]) : 5;
+    bool stealing = argc > 4 ? std::stoi(argv[4]) != 0 : false;
+
+    // 90% one-unit tasks, 10% thirty-unit tasks, in random order
+    std::mt19937 rng(7);
+    std::vector<int> durations;
+    for (int i = 0; i < taskCount; ++i) {
+        durations.push_back(rng() % 10 == 0 ? 30 : 1);
+    }
+
+    struct Policy {
+        const char* name;
+        SchedulerType type;
+    };
+    const Policy policies[] = {
+        {"FIFO", SchedulerType::FIFO},
+        {"RoundRobin", SchedulerType::RoundRobin},
+        {"LoadBalanced", SchedulerType::LoadBalanced},
+        {"PowerOfTwoChoices", SchedulerType::PowerOfTwoChoices},
+        {"LeastWork", SchedulerType::LeastWork},
+    };
+
+    LoggingService::getInstance()->setMinLogLevel(LogLevel::WARNING);
+    std::vector<Result> fifoOrder, sjfOrder;
+    for (const auto& policy : policies) {
+        fifoOrder.push_back(run(policy.type, false, nodeCount, durations, unitMs, stealing));
+        sjfOrder.push_back(run(policy.type, true, nodeCount, durations, unitMs, stealing));
+    }
+
+    std::printf("nodes: %d, tasks: %d (90%% x1, 10%% x30 units of %d ms), work stealing %s\n",
+                nodeCount, taskCount, unitMs, stealing ? "on" : "off");
+    std::printf("%-20s %12s %12s %12s %12s\n", "scheduler", "mean ms", "p99 ms", "SJF mean", "SJF p99");
+    for (size_t i = 0; i < fifoOrder.size(); ++i) {
+        std::printf("%-20s %12.0f %12.0f %12.0f %12.0f\n", policies[i].name,
+                    fifoOrder[i].meanMs, fifoOrder[i].p99Ms, sjfOrder[i].meanMs, sjfOrder[i].p99Ms);
+    }
+    return 0;
+}
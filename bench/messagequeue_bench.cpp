@@ -0,0 +1,93 @@
+// bench/messagequeue_bench.cpp
+// Throughput of MessageQueue<T, Policy::Mutex> versus MessageQueue<T, Policy::LockFree>
+// with N producers and N consumers, for single sends and batched sends.
+//
+// Usage: messagequeue_bench [messages per run]
+#include "../include/messagequeue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Messages are moved through the queue as unique_ptrs to exercise move-only payloads
+using Payload = std::unique_ptr<long>;
+
+template <typename Queue>
+double run(Queue& queue, int threads, long messages, size_t batch) {
+    long perProducer = messages / threads;
+    std::atomic<long> consumed(0);
+    std::atomic<long> checksum(0);
+
+    auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (int p = 0; p < threads; ++p) {
+        workers.emplace_back([&queue, perProducer, batch] {
+            std::vector<Payload> pending;
+            for (long i = 0; i < perProducer; ++i) {
+                if (batch <= 1) {
+                    queue.send(std::make_unique<long>(i));
+                    continue;
+                }
+                pending.push_back(std::make_unique<long>(i));
+                if (pending.size() == batch || i + 1 == perProducer) {
+                    queue.sendBatch(pending);
+                    pending.clear();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < threads; ++c) {
+        workers.emplace_back([&queue, &consumed, &checksum, batch] {
+            std::vector<Payload> received;
+            long sum = 0;
+            while (true) {
+                received.clear();
+                if (queue.receiveBatch(received, batch <= 1 ? 1 : batch) == 0) {
+                    break; // Closed and drained
+                }
+                for (auto& item : received) sum += *item;
+                consumed.fetch_add(static_cast<long>(received.size()));
+            }
+            checksum.fetch_add(sum);
+        });
+    }
+
+    for (int p = 0; p < threads; ++p) workers[p].join();
+    while (consumed.load() < perProducer * threads) {
+        std::this_thread::yield();
+    }
+    queue.close();
+    for (size_t i = threads; i < workers.size(); ++i) workers[i].join();
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    long expected = threads * (perProducer * (perProducer - 1) / 2);
+    if (checksum.load() != expected) {
+        std::fprintf(stderr, "checksum mismatch: %ld != %ld\n", checksum.load(), expected);
+    }
+    return consumed.load() / seconds / 1e6;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    long messages = argc > 1 ? std::stol(argv[1]) : 2000000;
+
+    std::printf("%-8s %-7s %14s %14s\n", "threads", "batch", "mutex Mmsg/s", "lockfree Mmsg/s");
+    for (int threads : {1, 4, 16}) {
+        for (size_t batch : {size_t(1), size_t(64)}) {
+            MessageQueue<Payload, Policy::Mutex> locked;
+            MessageQueue<Payload, Policy::LockFree> lockFree(4096);
+            double mutexRate = run(locked, threads, messages, batch);
+            double lockFreeRate = run(lockFree, threads, messages, batch);
+            std::printf("%-8d %-7zu %14.2f %14.2f\n", threads, batch, mutexRate, lockFreeRate);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+// bench/metrics_bench.cpp
+// Cost of the latency histograms behind /metrics:
+//   - LatencyHistogram::record from one thread and from several threads
+//     sharing one histogram (the hot-path cost)
+//   - LatencyHistogram::time around an empty call (two clock reads extra)
+//   - snapshot + Prometheus rendering of one histogram
+// and the percentile error against exact percentiles of the same values.
+//
+// Usage: metrics_bench [records per thread] [threads]
+#include "../include/Metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double nsPerOp(Clock::time_point start, long ops) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    long records = argc > 1 ? std::stol(argv[1]) : 10000000;
+    int threads = argc > 2 ? std::stoi(argv[2]) : 4;
+
+    // Log-normal values around 100 us, like request latencies
+    std::mt19937_64 rng(42);
+    std::lognormal_distribution<double> latency(std::log(100000.0), 1.0);
+    std::vector<uint64_t> values(1 << 16);
+    for (auto& value : values) {
+        value = static_cast<uint64_t>(latency(rng));
+    }
+    const size_t mask = values.size() - 1;
+
+    LatencyHistogram single;
+    auto start = Clock::now();
+    for (long i = 0; i < records; ++i) {
+        single.record(values[i & mask]);
+    }
+    double singleNs = nsPerOp(start, records);
+
+    LatencyHistogram shared;
+    std::vector<std::thread> workers;
+    start = Clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (long i = 0; i < records; ++i) {
+                shared.record(values[(i + t * 997) & mask]);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    double sharedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / records;
+
+    LatencyHistogram timed;
+    long timedCalls = records / 10;
+    volatile long sink = 0;
+    start = Clock::now();
+    for (long i = 0; i < timedCalls; ++i) {
+        timed.time([&] { sink = sink + 1; });
+    }
+    double timedNs = nsPerOp(start, timedCalls);
+
+    const int renders = 1000;
+    size_t bytes = 0;
+    start = Clock::now();
+    for (int i = 0; i < renders; ++i) {
+        MetricsWriter writer;
+        writer.histogram("bench_seconds", MetricsWriter::label("node", "1"), single.snapshot());
+        bytes = writer.str().size();
+    }
+    double renderUs = nsPerOp(start, renders) / 1000;
+
+    std::vector<uint64_t> sorted(values.begin(), values.end());
+    std::sort(sorted.begin(), sorted.end());
+    LatencyHistogram exact;
+    for (uint64_t value : values) exact.record(value);
+    HistogramSnapshot snapshot = exact.snapshot();
+
+    std::printf("record, 1 thread:        %.1f ns/op\n", singleNs);
+    std::printf("record, %d threads:       %.1f ns/op per thread (one shared histogram)\n", threads, sharedNs);
+    std::printf("time(empty call):        %.1f ns/op\n", timedNs);
+    std::printf("snapshot + render:       %.1f us (%zu bytes)\n", renderUs, bytes);
+    for (double q : {0.5, 0.9, 0.99, 0.999}) {
+        uint64_t truth = sorted[static_cast<size_t>(q * (sorted.size() - 1))];
+        uint64_t estimate = snapshot.percentile(q);
+        std::printf("p%-5g exact %9llu ns, histogram %9llu ns (%+.1f%%)\n", q * 100,
+                    static_cast<unsigned long long>(truth), static_cast<unsigned long long>(estimate),
+                    100.0 * (static_cast<double>(estimate) - truth) / truth);
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+// bench/preemption_latency_bench.cpp
+// Start latency of Critical tasks submitted while every node is busy with
+// Low-priority CPU-bound bulk work, with preemption off and with the
+// Critical policy. Latency runs from submission to the moment the task's
+// work begins. The bulk finishing time is reported to show the cost.
+//
+// Usage: preemption_latency_bench [nodes] [bulk tasks per node] [bulk iterations] [critical tasks]
+#include "../include/TaskManager.h"
+#include "../include/FIFOScheduler.h"
+#include "../include/DatabaseManager.h"
+#include "../include/TaskExecutor.h"
+#include "../include/loggingservice.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double p50Ms;
+    double p99Ms;
+    double maxMs;
+    double bulkSeconds;
+};
+
+Result run(PreemptionPolicy policy, int nodeCount, int bulkPerNode, uint64_t iterations, int criticalCount) {
+    TaskManager manager(std::make_unique<FIFOScheduler>(), ":memory:");
+    if (!manager.initialize()) {
+        return Result{-1, -1, -1, -1};
+    }
+    manager.setWorkStealing(false);
+    manager.setScheduler(SchedulerType::LoadBalanced);
+    manager.setPreemption(policy);
+    for (int i = 0; i < nodeCount; ++i) {
+        manager.addNode();
+    }
+
+    auto start = Clock::now();
+    std::vector<TaskSpec> bulk;
+    for (int i = 0; i < nodeCount * bulkPerNode; ++i) {
+        bulk.push_back(TaskSpec{"bulk", 1, std::make_shared<CpuExecutor>(iterations), TaskPriority::Low});
+    }
+    auto bulkIds = manager.addTasks(bulk);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    std::vector<double> latency(criticalCount);
+    std::atomic<int> started(0);
+    for (int i = 0; i < criticalCount; ++i) {
+        auto submitted = Clock::now();
+        auto executor = std::make_shared<CallableExecutor>([&latency, &started, i, submitted] {
+            latency[i] = std::chrono::duration<double, std::milli>(Clock::now() - submitted).count();
+            started++;
+            return true;
+        });
+        manager.addTask("critical", 0, executor, 0, TaskPriority::Critical);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    while (started.load() < criticalCount) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    for (int id : bulkIds) {
+        while (manager.getTask(id)->getStatus() != TaskStatus::Completed) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    double bulkSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    manager.getDbManager()->flush();
+
+    std::sort(latency.begin(), latency.end());
+    return Result{latency[criticalCount / 2], latency[criticalCount * 99 / 100], latency.back(), bulkSeconds};
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int nodeCount = argc > 1 ? std::stoi(argv[1]) : 4;
+    int bulkPerNode = argc > 2 ? std::stoi(argv[2]) : 4;
+    uint64_t iterations = argc > 3 ? std::stoull(argv[3]) : 50000000;
+    int criticalCount = argc > 4 ? std::stoi(argv[4]) : 40;
+
+    LoggingService::getInstance()->setMinLogLevel(LogLevel::WARNING);
+    Result off = run(PreemptionPolicy::Off, nodeCount, bulkPerNode, iterations, criticalCount);
+    Result critical = run(PreemptionPolicy::Critical, nodeCount, bulkPerNode, iterations, criticalCount);
+
+    std::printf("nodes: %d, bulk: %d Low tasks x %llu iterations, %d Critical tasks every 20 ms\n",
+                nodeCount, nodeCount * bulkPerNode, static_cast<unsigned long long>(iterations), criticalCount);
+    std::printf("%-12s %10s %10s %10s %12s\n", "preemption", "p50 ms", "p99 ms", "max ms", "bulk done s");
+    std::printf("%-12s %10.1f %10.1f %10.1f %12.2f\n", "off", off.p50Ms, off.p99Ms, off.maxMs, off.bulkSeconds);
+    std::printf("%-12s %10.1f %10.1f %10.1f %12.2f\n", "critical", critical.p50Ms, critical.p99Ms,
+                critical.maxMs, critical.bulkSeconds);
+    return 0;
+}
@@ -0,0 +1,128 @@
+// bench/scheduler_pick_bench.cpp
+// Cost of LoadBalancedScheduler::pickNode as the cluster grows: the scan
+// that locks every node for its task count versus the NodeLoadIndex heap.
+// Each indexed pick is followed by the update the chosen node would report.
+// PowerOfTwoChoicesScheduler is timed alongside.
+//
+// Then the balance each scheduler achieves: tasks are placed one at a time
+// on idle nodes and the spread of the resulting queue lengths is reported.
+//
+// Usage: scheduler_pick_bench [picks per size] [balance nodes] [tasks per node]
+#include "../include/FIFOScheduler.h"
+#include "../include/RoundRobinScheduler.h"
+#include "../include/LoadBalancedScheduler.h"
+#include "../include/PowerOfTwoChoicesScheduler.h"
+#include "../include/NodeLoadIndex.h"
+#include "../include/Node.h"
+#include "../include/loggingservice.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double nanosPerOp(Clock::time_point start, long ops) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+// Places nodeCount * tasksPerNode tasks through `scheduler` and prints the
+// mean, variance and maximum of the queue lengths
+void reportBalance(const char* name, Scheduler& scheduler, int nodeCount, int tasksPerNode) {
+    std::vector<std::shared_ptr<Node>> nodes;
+    for (int id = 1; id <= nodeCount; ++id) {
+        nodes.push_back(std::make_shared<Node>(id));
+    }
+
+    LoggingService::getInstance()->setMinLogLevel(LogLevel::WARNING);
+    int taskId = 1;
+    for (int i = 0; i < nodeCount * tasksPerNode; ++i) {
+        int position = scheduler.pickNode(nodes);
+        nodes[position]->addTask(std::make_shared<Task>(taskId++, "bench", 0));
+    }
+
+    double mean = tasksPerNode;
+    double variance = 0;
+    int maxLength = 0;
+    for (const auto& node : nodes) {
+        double diff = node->getTaskCount() - mean;
+        variance += diff * diff;
+        maxLength = std::max(maxLength, node->getTaskCount());
+    }
+    variance /= nodeCount;
+    std::printf("%-22s %8.1f %10.2f %8d\n", name, mean, variance, maxLength);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    long picks = argc > 1 ? std::stol(argv[1]) : 200000;
+    int balanceNodes = argc > 2 ? std::stoi(argv[2]) : 1000;
+    int tasksPerNode = argc > 3 ? std::stoi(argv[3]) : 10;
+
+    std::printf("%-8s %14s %14s %14s\n", "nodes", "scan ns/pick", "index ns/pick", "p2c ns/pick");
+    for (int nodeCount : {10, 1000, 100000}) {
+        std::vector<std::shared_ptr<Node>> nodes;
+        NodeLoadIndex index;
+        std::vector<int> loads(nodeCount + 1);
+        std::mt19937 rng(42);
+        for (int id = 1; id <= nodeCount; ++id) {
+            nodes.push_back(std::make_shared<Node>(id));
+            index.add(id);
+            loads[id] = static_cast<int>(rng() % 8);
+            index.update(id, loads[id], false);
+        }
+
+        // The scan is O(nodes) per pick; keep its total work bounded
+        long scanPicks = std::max(10L, std::min(picks, 20000000L / nodeCount));
+        LoadBalancedScheduler scanning;
+        long checksum = 0;
+        auto scanStart = Clock::now();
+        for (long i = 0; i < scanPicks; ++i) {
+            checksum += scanning.pickNode(nodes);
+        }
+        double scanNs = nanosPerOp(scanStart, scanPicks);
+
+        LoadBalancedScheduler indexed;
+        indexed.setLoadIndex(&index);
+        auto indexStart = Clock::now();
+        for (long i = 0; i < picks; ++i) {
+            int position = indexed.pickNode(nodes);
+            int id = nodes[position]->getId();
+            index.update(id, ++loads[id], false);
+            checksum += position;
+        }
+        double indexNs = nanosPerOp(indexStart, picks);
+
+        PowerOfTwoChoicesScheduler p2c;
+        auto p2cStart = Clock::now();
+        for (long i = 0; i < picks; ++i) {
+            checksum += p2c.pickNode(nodes);
+        }
+        double p2cNs = nanosPerOp(p2cStart, picks);
+
+        std::printf("%-8d %14.0f %14.0f %14.0f   (checksum %ld)\n", nodeCount, scanNs, indexNs, p2cNs, checksum);
+    }
+
+    std::printf("\nqueue lengths after %d tasks on %d nodes\n", balanceNodes * tasksPerNode, balanceNodes);
+    std::printf("%-22s %8s %10s %8s\n", "scheduler", "mean", "variance", "max");
+    FIFOScheduler fifo;
+    RoundRobinScheduler roundRobin;
+    LoadBalancedScheduler loadBalanced;
+    PowerOfTwoChoicesScheduler random(1);
+    PowerOfTwoChoicesScheduler twoChoices(2);
+    PowerOfTwoChoicesScheduler threeChoices(3);
+    reportBalance("FIFO", fifo, balanceNodes, tasksPerNode);
+    reportBalance("RoundRobin", roundRobin, balanceNodes, tasksPerNode);
+    reportBalance("LoadBalanced (scan)", loadBalanced, balanceNodes, tasksPerNode);
+    reportBalance("random (d=1)", random, balanceNodes, tasksPerNode);
+    reportBalance("p2c (d=2)", twoChoices, balanceNodes, tasksPerNode);
+    reportBalance("p2c (d=3)", threeChoices, balanceNodes, tasksPerNode);
+    return 0;
+}
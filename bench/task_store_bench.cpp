@@ -0,0 +1,107 @@
+// bench/task_store_bench.cpp
+// Memory per task and scan throughput of TaskManager's task store with a
+// large number of tasks in memory (run it once per size, e.g. 1000000 and
+// 10000000, since freed memory is not returned between sizes):
+//   - resident memory grown per task, after the database writer drained
+//   - full keyset pagination over every task
+//   - pending pagination (all tasks are pending: no nodes are registered)
+//   - completed pagination, which matches nothing and so walks every status
+//   - random getTask lookups
+//
+// Usage: task_store_bench [tasks] [database file]
+#include "../include/TaskManager.h"
+#include "../include/FIFOScheduler.h"
+#include "../include/DatabaseManager.h"
+#include "../include/loggingservice.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+size_t residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t total = 0, resident = 0;
+    statm >> total >> resident;
+    return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// Walks every page of up to `limit` tasks; returns tasks per second
+double scanRate(const TaskManager& manager, std::optional<TaskStatus> status, size_t& seen) {
+    const size_t limit = 1000;
+    seen = 0;
+    int cursor = 0;
+    auto start = Clock::now();
+    while (true) {
+        TaskPage page = manager.getTasksPage(cursor, limit, status);
+        seen += page.tasks.size();
+        if (page.nextAfterId == -1) break;
+        cursor = page.nextAfterId;
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return seen / seconds;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int taskCount = argc > 1 ? std::stoi(argv[1]) : 1000000;
+    std::string dbPath = argc > 2 ? argv[2] : "/tmp/task_store_bench.db";
+    std::remove(dbPath.c_str());
+
+    LoggingService::getInstance()->setMinLogLevel(LogLevel::WARNING);
+    TaskManager manager(std::make_unique<FIFOScheduler>(), dbPath);
+    if (!manager.initialize()) {
+        std::fprintf(stderr, "initialize failed\n");
+        return 1;
+    }
+    manager.getDbManager()->flush();
+    size_t before = residentBytes();
+
+    const int batchSize = 10000;
+    std::vector<TaskSpec> batch;
+    auto ingestStart = Clock::now();
+    for (int i = 0; i < taskCount; ++i) {
+        batch.push_back(TaskSpec{"bench", 1, nullptr});
+        if (static_cast<int>(batch.size()) == batchSize || i == taskCount - 1) {
+            manager.addTasks(batch);
+            batch.clear();
+            // Keep the writer's queue (and its row snapshots) short
+            manager.getDbManager()->flush();
+        }
+    }
+    double ingestSeconds = std::chrono::duration<double>(Clock::now() - ingestStart).count();
+    // The ready queue holds every task as well; count it with the store
+    double bytesPerTask = static_cast<double>(residentBytes() - before) / taskCount;
+
+    size_t allSeen = 0, pendingSeen = 0, completedSeen = 0;
+    double allRate = scanRate(manager, std::nullopt, allSeen);
+    double pendingRate = scanRate(manager, TaskStatus::Pending, pendingSeen);
+    auto completedStart = Clock::now();
+    scanRate(manager, TaskStatus::Completed, completedSeen);
+    double completedMs = std::chrono::duration<double, std::milli>(Clock::now() - completedStart).count();
+
+    std::mt19937 rng(42);
+    const int lookups = 1000000;
+    long found = 0;
+    auto lookupStart = Clock::now();
+    for (int i = 0; i < lookups; ++i) {
+        found += manager.getTask(1 + static_cast<int>(rng() % taskCount)) != nullptr;
+    }
+    double lookupNs = std::chrono::duration<double, std::nano>(Clock::now() - lookupStart).count() / lookups;
+
+    std::printf("tasks:                  %d (ingest %.1f s)\n", taskCount, ingestSeconds);
+    std::printf("resident memory:        %.0f bytes/task\n", bytesPerTask);
+    std::printf("scan all:               %.1f M tasks/s (%zu seen)\n", allRate / 1e6, allSeen);
+    std::printf("scan pending:           %.1f M tasks/s (%zu seen)\n", pendingRate / 1e6, pendingSeen);
+    std::printf("scan completed (none):  %.1f ms\n", completedMs);
+    std::printf("getTask:                %.0f ns/op (%ld found)\n", lookupNs, found);
+    std::remove(dbPath.c_str());
+    return 0;
+}
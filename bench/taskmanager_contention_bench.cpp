@@ -0,0 +1,76 @@
+// bench/taskmanager_contention_bench.cpp
+// Throughput of TaskManager driven from many threads at once: each thread
+// mixes addTask (the /add_task path) with getTask lookups, once with a
+// single task shard (equivalent to the old global mutex) and once sharded.
+//
+// Usage: taskmanager_contention_bench [threads] [operations per thread] [shards]
+#include "../include/TaskManager.h"
+#include "../include/FIFOScheduler.h"
+#include "../include/Node.h"
+#include "../include/DatabaseManager.h"
+#include "../include/loggingservice.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// One write in every `kLookupsPerAdd + 1` operations
+constexpr int kLookupsPerAdd = 3;
+
+double run(size_t shards, int threads, int opsPerThread) {
+    TaskManager manager(std::make_unique<FIFOScheduler>(), ":memory:", shards);
+    if (!manager.initialize()) {
+        return -1;
+    }
+
+    std::atomic<bool> go(false);
+    std::atomic<long> hits(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::minstd_rand rng(t + 1);
+            long found = 0;
+            while (!go.load()) std::this_thread::yield();
+            for (int i = 0; i < opsPerThread; ++i) {
+                if (i % (kLookupsPerAdd + 1) == 0) {
+                    manager.addTask("bench", 1);
+                } else {
+                    found += manager.getTask(static_cast<int>(rng() % (threads * opsPerThread / 4 + 1)) + 1) != nullptr;
+                }
+            }
+            hits.fetch_add(found);
+        });
+    }
+
+    auto start = Clock::now();
+    go = true;
+    for (auto& worker : workers) worker.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    manager.getDbManager()->flush();
+    return static_cast<double>(threads) * opsPerThread / seconds / 1e6;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int threads = argc > 1 ? std::stoi(argv[1]) : 32;
+    int ops = argc > 2 ? std::stoi(argv[2]) : 20000;
+    size_t shards = argc > 3 ? std::stoul(argv[3]) : 16;
+
+    LoggingService::getInstance()->setMinLogLevel(LogLevel::WARNING);
+    double single = run(1, threads, ops);
+    double sharded = run(shards, threads, ops);
+
+    std::printf("threads: %d, operations per thread: %d (1 add : %d lookups)\n", threads, ops, kLookupsPerAdd);
+    std::printf("1 shard:    %8.3f Mops/s\n", single);
+    std::printf("%zu shards:  %8.3f Mops/s\n", shards, sharded);
+    return 0;
+}
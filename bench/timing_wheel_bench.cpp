@@ -0,0 +1,90 @@
+// bench/timing_wheel_bench.cpp
+// TimingWheel with a large number of armed timers: cost of schedule and
+// cancel, CPU burned by the wheel thread while the timers wait (the old
+// scheduler polled every 100 ms), and how late short timers fire.
+//
+// Usage: timing_wheel_bench [armed timers] [short timers]
+#include "../include/TimingWheel.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double nanosPerOp(Clock::time_point start, long ops) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops;
+}
+
+double cpuSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    long armedCount = argc > 1 ? std::stol(argv[1]) : 1000000;
+    int shortCount = argc > 2 ? std::stoi(argv[2]) : 10000;
+
+    TimingWheel wheel;
+    wheel.start();
+    std::atomic<long> fired(0);
+
+    // Far-future timers, spread over every wheel level (10 s to 10 h)
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<long> delay(10000, 36000000);
+    std::vector<TimingWheel::TimerId> ids(armedCount);
+    auto scheduleStart = Clock::now();
+    for (long i = 0; i < armedCount; ++i) {
+        ids[i] = wheel.schedule(std::chrono::milliseconds(delay(rng)), [&fired] { fired++; });
+    }
+    double scheduleNs = nanosPerOp(scheduleStart, armedCount);
+
+    // Idle: the wheel thread should sleep through the whole interval
+    double cpuStart = cpuSeconds();
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    double idleCpuMs = (cpuSeconds() - cpuStart) * 1000;
+
+    // Short timers firing while the far ones stay armed
+    std::vector<Clock::time_point> deadlines(shortCount);
+    std::vector<double> lateness(shortCount);
+    std::atomic<int> shortFired(0);
+    std::uniform_int_distribution<int> shortDelay(1, 500);
+    for (int i = 0; i < shortCount; ++i) {
+        deadlines[i] = Clock::now() + std::chrono::milliseconds(shortDelay(rng));
+        wheel.scheduleAt(deadlines[i], [&, i] {
+            lateness[i] = std::chrono::duration<double, std::milli>(Clock::now() - deadlines[i]).count();
+            shortFired++;
+        });
+    }
+    while (shortFired.load() < shortCount) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::sort(lateness.begin(), lateness.end());
+
+    auto cancelStart = Clock::now();
+    long cancelled = 0;
+    for (long i = 0; i < armedCount; i += 2) {
+        cancelled += wheel.cancel(ids[i]);
+    }
+    double cancelNs = nanosPerOp(cancelStart, (armedCount + 1) / 2);
+    size_t remaining = wheel.size();
+    wheel.stop();
+
+    std::printf("armed timers:          %ld (fired early: %ld)\n", armedCount, fired.load());
+    std::printf("schedule:              %8.0f ns/op\n", scheduleNs);
+    std::printf("cancel:                %8.0f ns/op (%ld cancelled, %zu left)\n", cancelNs, cancelled, remaining);
+    std::printf("idle CPU over 1 s:     %8.2f ms\n", idleCpuMs);
+    std::printf("short timers:          %d, lateness p50 %.2f ms, p99 %.2f ms, max %.2f ms\n", shortCount,
+                lateness[shortCount / 2], lateness[shortCount * 99 / 100], lateness.back());
+    return 0;
+}
@@ -0,0 +1,77 @@
+// bench/work_stealing_bench.cpp
+// Makespan of a skewed workload that was push-assigned entirely to one node,
+// with idle nodes stealing from its queue versus the push-only model.
+//
+// Usage: work_stealing_bench [nodes] [durations...]
+//   durations are whole seconds (Node sleeps for Task::getDuration()),
+//   default: 2 1 1 1 0 0 1 2
+#include "../include/TaskManager.h"
+#include "../include/FIFOScheduler.h"
+#include "../include/Node.h"
+#include "../include/DatabaseManager.h"
+#include "../include/loggingservice.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double runMakespan(bool stealing, int nodeCount, const std::vector<int>& durations) {
+    TaskManager manager(std::make_unique<FIFOScheduler>(), ":memory:");
+    if (!manager.initialize()) {
+        return -1;
+    }
+    manager.setWorkStealing(stealing);
+    for (int i = 0; i < nodeCount; ++i) {
+        manager.addNode();
+    }
+    auto nodes = manager.getAllNodes();
+
+    // Build the skew directly: every task lands on the first node
+    std::vector<std::shared_ptr<Task>> tasks;
+    for (size_t i = 0; i < durations.size(); ++i) {
+        auto task = std::make_shared<Task>(static_cast<int>(i) + 1, "bench", durations[i]);
+        manager.getDbManager()->saveTask(task);
+        tasks.push_back(task);
+    }
+
+    auto start = Clock::now();
+    for (auto& task : tasks) {
+        nodes.front()->addTask(task);
+    }
+    for (auto& task : tasks) {
+        while (task->getStatus() != TaskStatus::Completed) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int nodeCount = argc > 1 ? std::stoi(argv[1]) : 4;
+    std::vector<int> durations;
+    for (int i = 2; i < argc; ++i) {
+        durations.push_back(std::stoi(argv[i]));
+    }
+    if (durations.empty()) {
+        durations = {2, 1, 1, 1, 0, 0, 1, 2};
+    }
+
+    int totalWork = 0;
+    for (int d : durations) totalWork += d;
+
+    LoggingService::getInstance()->setMinLogLevel(LogLevel::WARNING);
+    double push = runMakespan(false, nodeCount, durations);
+    double steal = runMakespan(true, nodeCount, durations);
+
+    std::printf("nodes: %d, tasks: %zu, total work: %d s\n", nodeCount, durations.size(), totalWork);
+    std::printf("push model makespan:     %6.2f s\n", push);
+    std::printf("work stealing makespan:  %6.2f s\n", steal);
+    return 0;
+}
@@ -1,10 +1,118 @@
 // Initialize the dashboard on load
 document.addEventListener('DOMContentLoaded', () => {
-    fetchData();
+    // The first poll always asks for a resync, which does the initial full fetch
+    pollChanges();
+    setInterval(pollChanges, CHANGE_POLL_MS);
+    connectEvents();
     fetchDbStats();
     fetchCurrentScheduler();
 });
 
+// Incremental refresh: poll /changes for mutations since the last version
+// seen and patch the page, instead of refetching every task each time
+const CHANGE_POLL_MS = 2000;
+let changeVersion = -1;
+let pollInFlight = false;
+
+async function pollChanges() {
+    if (pollInFlight || pushConnected) {
+        return;
+    }
+    pollInFlight = true;
+    try {
+        let more = true;
+        while (more) {
+            const res = await fetch(`http://localhost:5000/changes?since=${changeVersion}`);
+            const data = await res.json();
+            changeVersion = data.version;
+
+            if (data.resync) {
+                // Fell behind the server's change log (or first load)
+                fetchData();
+                return;
+            }
+
+            let nodesChanged = false;
+            data.changes.forEach(change => {
+                if (change.task) {
+                    applyTaskChange(change.task);
+                }
+                if (change.node_id !== undefined) {
+                    nodesChanged = true;
+                }
+            });
+            if (data.changes.length > 0) {
+                if (nodesChanged) {
+                    fetchNodes();
+                }
+                updateOverview();
+            }
+            more = data.more;
+        }
+    } catch (err) {
+        // Server unreachable; the next poll tries again
+    } finally {
+        pollInFlight = false;
+    }
+}
+
+// While the /ws push channel is up, polling is paused. Frames share the
+// change log's version numbers, so either path can pick up where the other left off.
+const EVENTS_URL = "ws://localhost:18080/ws";
+const EVENTS_RETRY_MS = 5000;
+let pushConnected = false;
+
+function connectEvents() {
+    let socket;
+    try {
+        socket = new WebSocket(EVENTS_URL);
+    } catch (err) {
+        return;
+    }
+
+    socket.onopen = () => {
+        pushConnected = true;
+    };
+
+    socket.onmessage = (message) => {
+        const frame = JSON.parse(message.data);
+        if (frame.type === 'hello' || frame.type === 'resync') {
+            if (frame.type === 'resync' || frame.version !== changeVersion) {
+                fetchData();
+            }
+        } else if (frame.type === 'events') {
+            frame.tasks.forEach(applyTaskChange);
+            if (frame.nodes.length > 0 || frame.tasks.some(task => task.node_id !== undefined)) {
+                fetchNodes();
+            }
+            updateOverview();
+        }
+        changeVersion = frame.version;
+        // The server sends the next frame only after this
+        socket.send('ack');
+    };
+
+    socket.onclose = () => {
+        pushConnected = false;
+        setTimeout(connectEvents, EVENTS_RETRY_MS);
+    };
+}
+
+function applyTaskChange(task) {
+    const row = document.getElementById(`task-row-${task.id}`);
+    if (row) {
+        row.querySelector('.task-status').innerHTML = getStatusBadge(task.status);
+        return;
+    }
+    // New task: only append when the table already shows the last page
+    const rows = document.getElementById('taskRows');
+    if (rows && nextTaskCursor === null) {
+        rows.insertAdjacentHTML('beforeend', taskRowsHtml([task]));
+    } else if (!rows) {
+        fetchTasks();
+    }
+}
+
 // Main data fetch function to get both tasks and nodes
 async function fetchData() {
     fetchTasks();
@@ -127,17 +235,18 @@ function getStatusBadge(status) {
 // Update dashboard overview statistics
 async function updateOverview() {
     try {
-        const [tasksRes, nodesRes] = await Promise.all([
-            fetch("http://localhost:5000/tasks"),
+        // Totals come from the server's live counters rather than the task list
+        const [statsRes, nodesRes] = await Promise.all([
+            fetch("http://localhost:5000/db_stats"),
             fetch("http://localhost:5000/nodes")
         ]);
 
-        const tasks = await tasksRes.json();
+        const stats = await statsRes.json();
         const nodes = await nodesRes.json();
 
-        const pendingTasks = tasks.filter(t => t.status === 0).length;
-        const runningTasks = tasks.filter(t => t.status === 1).length;
-        const completedTasks = tasks.filter(t => t.status === 2).length;
+        const totalTasks = stats.total_tasks;
+        const runningTasks = stats.running_tasks;
+        const completedTasks = stats.completed_tasks;
 
         const overview = document.getElementById('overview');
         overview.innerHTML = `
@@ -148,7 +257,7 @@ async function updateOverview() {
             </div>
             <div class="stat-card">
               <i class="fas fa-tasks"></i>
-              <h3>${tasks.length}</h3>
+              <h3>${totalTasks}</h3>
               <p>Total Tasks</p>
             </div>
             <div class="stat-card">
@@ -268,6 +377,32 @@ async function submitAddTask() {
     }
 }
 
+// /tasks is paginated: the table shows one page at a time and
+// "Load more" follows the next_after_id cursor
+const TASK_PAGE_SIZE = 100;
+let nextTaskCursor = null;
+let taskRowCount = 0;
+
+function taskRowsHtml(tasks) {
+    return tasks.map(task => {
+        taskRowCount++;
+        return `<tr id="task-row-${task.id}">
+                <td>${taskRowCount}</td>
+                <td>${task.id}</td>
+                <td>${task.name}</td>
+                <td>${task.duration}</td>
+                <td class="task-status">${getStatusBadge(task.status)}</td>
+              </tr>`;
+    }).join('');
+}
+
+function updateLoadMoreButton() {
+    const button = document.getElementById('loadMoreTasks');
+    if (button) {
+        button.style.display = nextTaskCursor === null ? 'none' : '';
+    }
+}
+
 async function fetchTasks() {
     try {
         const taskBody = document.getElementById('taskSection').querySelector('.card-body');
@@ -277,10 +412,12 @@ async function fetchTasks() {
             </div>
           `;
 
-        const res = await fetch("http://localhost:5000/tasks");
+        const res = await fetch(`http://localhost:5000/tasks?limit=${TASK_PAGE_SIZE}`);
         const data = await res.json();
+        nextTaskCursor = data.next_after_id;
+        taskRowCount = 0;
 
-        if (data.length === 0) {
+        if (data.tasks.length === 0) {
             taskBody.innerHTML = `
               <div style="text-align: center; padding: 20px; color: #6c757d;">
                 <i class="fas fa-info-circle" style="font-size: 24px; margin-bottom: 10px;"></i>
@@ -300,20 +437,16 @@ async function fetchTasks() {
                 <th>Status</th>
               </tr>
             </thead>
-            <tbody>`;
+            <tbody id="taskRows">`;
 
-        data.forEach((task, i) => {
-            html += `<tr>
-                <td>${i + 1}</td>
-                <td>${task.id}</td>
-                <td>${task.name}</td>
-                <td>${task.duration}</td>
-                <td>${getStatusBadge(task.status)}</td>
-              </tr>`;
-        });
+        html += taskRowsHtml(data.tasks);
 
-        html += `</tbody></table>`;
+        html += `</tbody></table>
+            <div style="text-align: center; padding: 10px;">
+              <button id="loadMoreTasks" class="btn btn-primary" onclick="loadMoreTasks()">Load more</button>
+            </div>`;
         taskBody.innerHTML = html;
+        updateLoadMoreButton();
     } catch (err) {
         showNotification(`Failed to fetch tasks: ${err}`, 'error');
         document.getElementById('taskSection').querySelector('.card-body').innerHTML = `
@@ -325,6 +458,21 @@ async function fetchTasks() {
     }
 }
 
+async function loadMoreTasks() {
+    if (nextTaskCursor === null) {
+        return;
+    }
+    try {
+        const res = await fetch(`http://localhost:5000/tasks?limit=${TASK_PAGE_SIZE}&after_id=${nextTaskCursor}`);
+        const data = await res.json();
+        nextTaskCursor = data.next_after_id;
+        document.getElementById('taskRows').insertAdjacentHTML('beforeend', taskRowsHtml(data.tasks));
+        updateLoadMoreButton();
+    } catch (err) {
+        showNotification(`Failed to load more tasks: ${err}`, 'error');
+    }
+}
+
 async function fetchNodes() {
     try {
         const nodeBody = document.getElementById('nodeSection').querySelector('.card-body');
@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Task.h"
+
+enum class ChangeType { TaskCreated, TaskStatusChanged, TaskAssigned, NodeAdded, NodeRemoved };
+
+struct ChangeRecord {
+    long long version;
+    ChangeType type;
+    int taskId;          // -1 for node records
+    int nodeId;          // -1 when no node is involved
+    TaskStatus status;   // task status after the change (task records only)
+};
+
+// Bounded, versioned log of TaskManager mutations. Every append gets the next
+// version number; only the newest `capacity` records are kept, so a reader
+// whose cursor has fallen out of the window must resync from a full fetch.
+//
+// Appends take no lock: a writer claims a version with one atomic increment
+// and publishes the record in the ring slot for that version, stamped with
+// the version once it is complete. Readers only see versions up to the
+// first record still being written, so they never skip one, and a slot
+// overwritten while being read is reported as evicted. The mutex and
+// condition variable are only touched when a reader is parked in
+// waitForChange().
+class ChangeLog {
+public:
+    // Rounded up to a power of two
+    explicit ChangeLog(size_t capacity = 16384);
+
+    // Returns the version assigned to the record
+    long long append(ChangeType type, int taskId, int nodeId, TaskStatus status = TaskStatus::Pending);
+
+    // Appends up to maxRecords records with version > since to `out`.
+    // Returns false if records after `since` were already evicted.
+    bool getSince(long long since, size_t maxRecords, std::vector<ChangeRecord>& out) const;
+
+    // Newest version whose record, and every one before it, is complete
+    long long getVersion() const;
+
+    // Blocks until the version is past `since` or `keepWaiting` is false;
+    // returns the version. Whoever clears keepWaiting calls wakeWaiters().
+    long long waitForChange(long long since, const std::atomic<bool>& keepWaiting) const;
+    void wakeWaiters();
+
+    static const char* typeName(ChangeType type);
+
+private:
+    struct Slot {
+        // Version of the record held; 0 while it is being rewritten
+        std::atomic<long long> version{0};
+        std::atomic<uint64_t> ids{0};     // task id << 32 | node id
+        std::atomic<uint32_t> kind{0};    // type | status << 8
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    // Last version handed to a writer
+    std::atomic<long long> assigned;
+    // Lower bound of getVersion(), advanced by readers
+    mutable std::atomic<long long> published;
+
+    mutable std::atomic<int> waiters;
+    mutable std::mutex mtx;
+    mutable std::condition_variable changed;
+
+    // Copies out the record of `version`; false if its slot holds another one
+    bool readSlot(long long version, ChangeRecord& out) const;
+};
@@ -2,56 +2,160 @@
 #include <string>
 #include <memory>
 #include <vector>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <unordered_map>
 #include <sqlite3.h>
 #include "Task.h"
 #include "Node.h"
+#include "Metrics.h"
 
 // Forward declaration
 class TaskManager;
 
+// SQLite "PRAGMA synchronous" level used together with WAL journaling
+enum class SyncMode { Off, Normal, Full };
+
+// Group-commit counters reported by the writer thread
+struct BatchStats {
+    long long commits = 0;
+    long long jobs = 0;
+    size_t lastBatchSize = 0;
+    size_t maxBatchSize = 0;
+    double lastCommitMs = 0.0;
+    double maxCommitMs = 0.0;
+    double totalCommitMs = 0.0;
+};
+
+// Persistence is write-behind: mutating calls queue a record and return
+// immediately, and a single writer thread owns the sqlite3 connection and
+// applies the queue in order. Reads are executed on the writer thread too, so
+// they always observe every write queued before them.
+//
+// Writes are group-committed: the writer collects jobs into one
+// BEGIN/COMMIT until the batch reaches its size limit or its time window
+// closes, so many writes share a single WAL sync.
 class DatabaseManager {
 public:
     DatabaseManager(const std::string& dbPath = "taskmaster.db");
     ~DatabaseManager();
-    
-    // Database initialization
+
+    // Group-commit configuration; call before initialize()
+    void setSyncMode(SyncMode mode);
+    void setBatchLimits(size_t maxBatchSize, std::chrono::milliseconds window);
+    // Whether persisted command tasks are restored with their command (off
+    // by default); call before loading tasks
+    void setAllowCommands(bool allow);
+
+    // Database initialization (also starts the writer thread)
     bool initialize();
-    
+
+    // Blocks until every write queued before this call has been committed
+    void flush();
+
+    BatchStats getBatchStats() const;
+    // Duration of each batch commit
+    const LatencyHistogram& getCommitTimes() const;
+    // Time from queueing each write to the commit that included it
+    const LatencyHistogram& getWriteLatencies() const;
+
     // Task operations
     bool saveTask(const std::shared_ptr<Task>& task);
+    // Inserts the tasks and, where nodeIds[i] != -1, their node assignments
+    // as a single queued job, so they always commit in one transaction
+    bool saveTasks(const std::vector<std::shared_ptr<Task>>& tasks, const std::vector<int>& nodeIds);
     bool updateTaskStatus(int taskId, TaskStatus status);
+    // Also stores the task's assigned/started/finished timestamps
+    bool updateTaskStatus(int taskId, TaskStatus status, const TaskTimeline& timeline);
     std::vector<std::shared_ptr<Task>> loadAllTasks();
     std::shared_ptr<Task> loadTask(int taskId);
     bool deleteTask(int taskId);
-    
+
     // Node operations
     bool saveNode(const std::shared_ptr<Node>& node);
     bool updateNodeTaskCount(int nodeId, int taskCount);
     std::vector<std::shared_ptr<Node>> loadAllNodes(TaskManager* manager);
     bool deleteNode(int nodeId);
-    
+
     // Task assignment operations
     bool assignTaskToNode(int taskId, int nodeId);
     bool removeTaskFromNode(int taskId, int nodeId);
     std::vector<int> getNodeTaskIds(int nodeId);
-    
+
     // Statistics/info operations
     int getTaskCount();
     int getNodeCount();
     int getPendingTaskCount();
     int getRunningTaskCount();
     int getCompletedTaskCount();
-    
+
     // Utility functions
     int getLastInsertId();
     int getMaxTaskId();
     int getMaxNodeId();
-    
+
 private:
     sqlite3* db;
     std::string dbPath;
-    
-    // Helper methods for statement preparation and error handling
+
+    // Prepared statements keyed by SQL text. Each statement is compiled once
+    // and then reset/rebound on every call instead of being finalized.
+    // Only touched from the writer thread.
+    std::unordered_map<std::string, sqlite3_stmt*> statementCache;
+
+    // Unit of work for the writer thread. Urgent jobs (reads, flushes) close
+    // the current batch instead of waiting out the window; onCommit runs
+    // after the batch containing the job has been committed.
+    struct Job {
+        std::function<void()> apply;
+        std::function<void()> onCommit;
+        bool urgent = false;
+        // When the job was queued, for the write latency histogram
+        std::chrono::steady_clock::time_point queuedAt;
+    };
+
+    // Write-behind queue drained by the writer thread
+    std::deque<Job> jobQueue;
+    std::mutex queueMtx;
+    std::condition_variable queueCv;
+    std::thread writer;
+    bool stopping;
+
+    SyncMode syncMode;
+    size_t maxBatchSize;
+    std::chrono::milliseconds batchWindow;
+    bool allowCommands;
+
+    BatchStats batchStats;
+    mutable std::mutex statsMtx;
+    LatencyHistogram commitTimes;
+    LatencyHistogram writeLatencies;
+
+    void writerLoop();
+    void commitBatch(std::vector<Job>& batch);
+    void stopWriter();
+    // Queues a job for the writer thread; runs it inline if the writer is not running
+    bool enqueue(Job job);
+    bool enqueue(std::function<void()> apply);
+    // Runs a read on the writer thread and waits for its result
+    template <typename T>
+    T runQuery(std::function<T()> query);
+    int scalarQuery(const std::string& sql);
+
+    // Helper methods for statement preparation and error handling.
+    // Returned statements are owned by the cache: reset them, never finalize.
     sqlite3_stmt* prepareStatement(const std::string& sql);
+    // Schema migration: adds `column` to `table` if it is missing
+    bool ensureColumn(const std::string& table, const std::string& column, const std::string& definition);
+    // Sets the task's executor from the (executor, payload) columns starting
+    // at `column`. A task whose executor is disabled or cannot be rebuilt is
+    // marked failed and Completed instead of being left to sleep.
+    void restoreExecutor(Task& task, sqlite3_stmt* stmt, int column);
+    // The (submitted_at, assigned_at, started_at, finished_at) columns starting at `column`
+    static TaskTimeline readTimeline(sqlite3_stmt* stmt, int column);
     void logError(const std::string& operation);
-};
\ No newline at end of file
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+class TaskManager;
+
+// Pushes task and node events to subscribed clients (the /ws endpoint).
+//
+// A background thread sleeps until TaskManager's change log moves, lets the
+// burst run for one window, then folds the new records into each client's
+// pending set, keyed by task/node id, so a task that changed several times
+// in a window is sent once with its latest state. Clients get one frame at a time and must acknowledge it
+// (any message) before the next is sent; while a slow client has a frame
+// outstanding its changes keep coalescing. If its pending set outgrows
+// maxPending, it is dropped and the client is told to resync instead.
+//
+// Frames are JSON text:
+//   {"type":"hello","version":V}
+//   {"type":"events","version":V,"tasks":[{id,name,duration,status,node_id}],
+//    "nodes":[{"id":N,"event":"added"|"removed"}]}
+//   {"type":"resync","version":V}
+// After a resync, refetch /tasks and /nodes and keep applying events.
+class EventBroadcaster {
+public:
+    using Sink = std::function<void(const std::string&)>;
+
+    EventBroadcaster(TaskManager& manager,
+                     std::chrono::milliseconds window = std::chrono::milliseconds(100),
+                     size_t maxPending = 256);
+    ~EventBroadcaster();
+
+    void start();
+    void stop();
+
+    // Registers a client and sends it a hello frame; returns the client id.
+    // `sink` is only ever called under the broadcaster's lock, and never
+    // after unsubscribe() returns.
+    int subscribe(Sink sink);
+    void unsubscribe(int clientId);
+    // The client processed its last frame and can take the next one
+    void acknowledge(int clientId);
+
+    size_t getClientCount() const;
+
+private:
+    struct Client {
+        Sink sink;
+        // task id -> last node it was assigned to in the window (-1 if none)
+        std::map<int, int> tasks;
+        // node id -> true if added, false if removed
+        std::map<int, bool> nodes;
+        bool awaitingAck = false;
+        bool overflowed = false;
+    };
+
+    TaskManager& manager;
+    std::chrono::milliseconds window;
+    size_t maxPending;
+
+    mutable std::mutex mtx;
+    std::condition_variable cv;
+    std::unordered_map<int, Client> clients;
+    int nextClientId;
+    long long version;
+    // Written under mtx; atomic because the worker reads it while blocked
+    // on the change log
+    std::atomic<bool> running;
+    std::thread worker;
+
+    void run();
+    // Reads new change log records into every client's pending set. Caller holds mtx.
+    void collectLocked();
+    // Sends one frame to the client if it has anything pending. Caller holds mtx.
+    void flushLocked(Client& client);
+    std::string buildEventsFrame(const Client& client) const;
+};
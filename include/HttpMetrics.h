@@ -0,0 +1,61 @@
+#pragma once
+#include "crow.h"
+#include "Metrics.h"
+#include <cctype>
+#include <chrono>
+#include <string>
+
+// Crow middleware timing every HTTP request from routing to the end of the
+// response, per method and path. Numeric path segments are reported as
+// <int>, so /tasks/7 and /tasks/8 share one histogram. Paths that no route
+// matched (404s not seen before) are all reported as handler="other".
+struct HttpMetrics {
+    struct context {
+        // Requests that match no route skip before_handle
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    };
+
+    HttpMetrics() : latencies(MetricsWriter::label("handler", "other")) {}
+
+    void before_handle(crow::request& /*req*/, crow::response& /*res*/, context& ctx) {
+        ctx.start = std::chrono::steady_clock::now();
+    }
+
+    void after_handle(crow::request& req, crow::response& res, context& ctx) {
+        auto elapsed = std::chrono::steady_clock::now() - ctx.start;
+        std::string labels = MetricsWriter::label("method", crow::method_name(req.method)) + "," +
+                             MetricsWriter::label("handler", routeOf(req.url));
+        LatencyHistogram* histogram = latencies.find(labels);
+        if (!histogram) {
+            histogram = res.code == 404 ? &latencies.overflowHistogram() : &latencies.get(labels);
+        }
+        histogram->record(elapsed);
+    }
+
+    void writeMetrics(MetricsWriter& out) const {
+        out.family("taskmaster_http_request_seconds", "histogram",
+                   "Time to handle one HTTP request, by method and route.");
+        latencies.forEach([&](const std::string& labels, const LatencyHistogram& histogram) {
+            out.histogram("taskmaster_http_request_seconds", labels, histogram.snapshot());
+        });
+    }
+
+private:
+    LabeledHistograms latencies;
+
+    static std::string routeOf(const std::string& url) {
+        std::string route;
+        size_t start = 0;
+        while (start < url.size()) {
+            size_t end = url.find('/', start + 1);
+            if (end == std::string::npos) end = url.size();
+            bool numeric = end > start + 1;
+            for (size_t i = start + 1; i < end; ++i) {
+                numeric = numeric && std::isdigit(static_cast<unsigned char>(url[i]));
+            }
+            route += numeric ? std::string("/<int>") : url.substr(start, end - start);
+            start = end;
+        }
+        return route;
+    }
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include "Scheduler.h"
+
+// Places each task on the node with the least outstanding work: the summed
+// declared durations of what it has queued plus what is left of its running
+// tasks (Node::getOutstandingWork), rather than the number of tasks. One long
+// task weighs as much as many short ones. Nodes are read without locking them.
+class LeastWorkScheduler : public Scheduler {
+public:
+    int pickNode(const std::vector<std::shared_ptr<Node>>& nodes) override;
+    // Without the tasks, each one is counted as one second of work
+    std::vector<int> pickNodes(const std::vector<std::shared_ptr<Node>>& nodes, size_t count) override;
+    // Adds each placed task's duration to its node before the next pick
+    std::vector<int> pickNodesForTasks(const std::vector<std::shared_ptr<Node>>& nodes,
+                                       const std::vector<std::shared_ptr<Task>>& tasks) override;
+
+private:
+    std::vector<int> pickByWork(const std::vector<std::shared_ptr<Node>>& nodes,
+                                const std::vector<long long>& taskWork);
+};
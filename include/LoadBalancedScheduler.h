@@ -3,5 +3,16 @@
 
 class LoadBalancedScheduler : public Scheduler {
 public:
+    // With a load index (see NodeLoadIndex) a pick is one heap lookup and no
+    // node is locked; without one every node is asked for its load
     int pickNode(const std::vector<std::shared_ptr<Node>>& nodes) override;
-};
\ No newline at end of file
+    // Spreads the batch so every pick goes to the least loaded node,
+    // counting the tasks already picked for it in this batch
+    std::vector<int> pickNodes(const std::vector<std::shared_ptr<Node>>& nodes, size_t count) override;
+    void setLoadIndex(NodeLoadIndex* index) override;
+
+private:
+    NodeLoadIndex* loadIndex = nullptr;
+
+    int scanForLeastLoaded(const std::vector<std::shared_ptr<Node>>& nodes) const;
+};
@@ -0,0 +1,139 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Counts of a LatencyHistogram at one point in time
+struct HistogramSnapshot {
+    std::vector<uint64_t> counts;  // per bucket
+    uint64_t count = 0;
+    uint64_t sumNanos = 0;
+
+    // Nanoseconds at or below which a fraction q (0-1) of the values fall,
+    // as the upper end of the bucket that holds that value; 0 when empty
+    uint64_t percentile(double q) const;
+    // Values below `nanos` (a power of two, so a bucket boundary)
+    uint64_t countBelow(uint64_t nanos) const;
+};
+
+// Log-linear histogram of durations in nanoseconds, in the style of
+// HdrHistogram: every power of two is split into kSubBuckets linear buckets,
+// so a value is known to within 1/kSubBuckets of itself at any magnitude.
+// record() is two relaxed atomic adds and never locks, so it can sit on
+// hot paths and be called from any thread.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    // Values of 2^kMaxExponent ns (about 78 hours) and up share the last bucket
+    static constexpr int kMaxExponent = 48;
+    static constexpr size_t kBucketCount = (kMaxExponent - kSubBucketBits + 1) * kSubBuckets;
+
+    LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t nanos);
+    void record(std::chrono::steady_clock::duration elapsed);
+
+    // Runs f() and records how long it took; returns what f() returned
+    template <typename F>
+    auto time(F&& f) {
+        auto start = std::chrono::steady_clock::now();
+        if constexpr (std::is_void_v<decltype(f())>) {
+            f();
+            record(std::chrono::steady_clock::now() - start);
+        } else {
+            auto result = f();
+            record(std::chrono::steady_clock::now() - start);
+            return result;
+        }
+    }
+
+    // Sums the buckets
+    uint64_t getCount() const;
+    // Not atomic across buckets: values recorded meanwhile may or may not show
+    HistogramSnapshot snapshot() const;
+
+    static size_t bucketIndex(uint64_t nanos);
+    // Smallest value that lands in the bucket
+    static uint64_t bucketLowerBound(size_t index);
+
+private:
+    // The total count is the sum of the buckets, which keeps record() off
+    // one more shared cache line
+    std::atomic<uint64_t> counts[kBucketCount];
+    std::atomic<uint64_t> sumNanos;
+};
+
+// Histograms keyed by a Prometheus label set such as `scheduler="FIFO"`.
+// Looking up a label that exists never locks: entries are published with a
+// release store and never removed, and only adding a label takes the mutex.
+// Past kCapacity labels, new ones share the overflow entry.
+class LabeledHistograms {
+public:
+    static constexpr size_t kCapacity = 64;
+
+    explicit LabeledHistograms(std::string overflowLabel);
+    ~LabeledHistograms();
+
+    LabeledHistograms(const LabeledHistograms&) = delete;
+    LabeledHistograms& operator=(const LabeledHistograms&) = delete;
+
+    // The histogram for `labels`, added if needed
+    LatencyHistogram& get(std::string_view labels);
+    // The histogram for `labels`, or nullptr; never adds one
+    LatencyHistogram* find(std::string_view labels) const;
+    LatencyHistogram& overflowHistogram();
+
+    // Calls f(labels, histogram) for every entry that has been used
+    template <typename F>
+    void forEach(F&& f) const {
+        for (const auto& slot : entries) {
+            const Entry* entry = slot.load(std::memory_order_acquire);
+            if (!entry) break;
+            f(entry->labels, entry->histogram);
+        }
+        if (overflow.histogram.getCount() > 0) {
+            f(overflow.labels, overflow.histogram);
+        }
+    }
+
+private:
+    struct Entry {
+        explicit Entry(std::string labels) : labels(std::move(labels)) {}
+        std::string labels;
+        LatencyHistogram histogram;
+    };
+
+    std::atomic<Entry*> entries[kCapacity];
+    std::mutex addMtx;
+    Entry overflow;
+};
+
+// Builds a response in the Prometheus text exposition format
+class MetricsWriter {
+public:
+    // HELP and TYPE lines; call once per metric name, before its samples
+    void family(std::string_view name, std::string_view type, std::string_view help);
+    // One sample line; `labels` is a label set without braces, or empty
+    void sample(std::string_view name, std::string_view labels, double value);
+    // The _bucket, _sum and _count lines of a histogram in seconds. Buckets
+    // are the powers of two of nanoseconds from about 1 us to about 69 s.
+    void histogram(std::string_view name, std::string_view labels, const HistogramSnapshot& snapshot);
+
+    // `key="value"` with the value escaped for the text format
+    static std::string label(std::string_view key, std::string_view value);
+
+    const std::string& str() const;
+
+private:
+    std::string out;
+};
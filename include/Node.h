@@ -1,12 +1,15 @@
 #pragma once
-#include <queue>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
 #include <vector>
 #include <memory>
 #include <atomic>
+#include <random>
 #include "Task.h"
+#include "TaskQueue.h"
+#include "Metrics.h"
 
 // Forward declarations to break circular dependencies
 class TaskManager;
@@ -14,29 +17,98 @@ class TaskManager;
 class Node {
 private:
     int id;
-    std::atomic<bool> busy;
+    // Executor slots: each runs one task at a time on its own thread
+    size_t slotCount;
+    std::atomic<int> activeSlots;
     std::atomic<bool> running;
-    std::thread worker;
-    std::queue<std::shared_ptr<Task>> taskQueue;
+    std::vector<std::thread> workers;
+    // The owner pops the most urgent task, idle peers steal the least urgent
+    TaskQueue taskQueue;
     TaskManager* taskManager;
     mutable std::mutex mtx;
     std::condition_variable cv;
     // NEW FIELDS
     int taskCount = 0;
     std::vector<int> taskIDs;
+    // Mirror of taskCount for lock-free readers, kept by reportLoadLocked()
+    std::atomic<int> load;
+    // Sum of the durations (seconds) of queued and running tasks
+    std::atomic<long long> outstandingWork;
+    // Task on each executor slot, nullptr while the slot is idle
+    std::vector<std::shared_ptr<Task>> runningTasks;
+    // When each slot's task started (Task::clockMicros) and its declared
+    // duration, 0 while idle; read by getOutstandingWork() without the lock
+    struct SlotClock {
+        std::atomic<long long> startedAt{0};
+        std::atomic<int> duration{0};
+    };
+    std::unique_ptr<SlotClock[]> slotClocks;
+    PreemptionPolicy preemptionPolicy;
+    // Times one task may be preempted before it is left to finish
+    int preemptionBudget;
+    // How long each run of a task on this node took; its sum is the node's
+    // total busy time
+    LatencyHistogram executionTimes;
     
 public:
     explicit Node(int id);
-    Node(int id, TaskManager* manager);
+    Node(int id, TaskManager* manager, size_t slots = 1);
     void start();
     void stop();
     void addTask(std::shared_ptr<Task> task);
+    // Queues several tasks under one lock with a single node-count update
+    void addTasks(const std::vector<std::shared_ptr<Task>>& tasks);
+    // True while every executor slot is running a task
     bool isBusy() const;
+    size_t getSlotCount() const;
     int getId() const;
     int getTaskCount() const;
+    // Queued + running tasks as last reported, read without the node lock
+    int getLoad() const;
+    // Work left here, in milliseconds: the declared durations of queued
+    // tasks plus what remains of each running task's declared duration
+    // after the time it has run. Read without the node lock.
+    long long getOutstandingWork() const;
+    // Tasks queued here and not yet started
+    size_t getQueueDepth() const;
+    // Executor slots running a task right now
+    int getActiveSlots() const;
+    const LatencyHistogram& getExecutionTimes() const;
+    // Run queued tasks of the same priority shortest first (SJF) instead of
+    // in arrival order; enabling it reorders what is already queued
+    void setShortestJobFirst(bool enabled);
+    // How long a queued task waits before moving up one priority level
+    void setPriorityAging(std::chrono::milliseconds interval);
+    // Off by default
+    void setPreemption(PreemptionPolicy policy, int budget);
+    // When every slot is busy, asks the least urgent preemptible running
+    // task that the policy allows to yield to `priority` work. Returns
+    // false if nothing was asked (or a slot is already being freed).
+    bool preemptFor(TaskPriority priority);
     std::vector<int> getTaskIDs() const;
     std::vector<std::shared_ptr<Task>> getTaskQueueSnapshot();
+    // Removes and returns every queued (not yet started) task
+    std::vector<std::shared_ptr<Task>> drainQueue();
+    // Takes the least urgent queued task. Only succeeds while the node is
+    // running and all its slots are busy.
+    std::shared_ptr<Task> stealTask();
+    // Wakes the idle executor slots so they re-check whether to steal
+    void wake();
     
 private:
-    void processTasks();
+    // Worker loop of one executor slot
+    void processTasks(size_t slot);
+    // Steals one task from a random busy peer into this node's queue
+    bool stealWork(std::minstd_rand& rng);
+    // Queues the task and counts its work. Caller holds mtx.
+    void enqueueLocked(const std::shared_ptr<Task>& task);
+    bool preemptForLocked(TaskPriority priority);
+    // Bookkeeping once a task has stopped running on `slot`
+    void completeTask(size_t slot, const std::shared_ptr<Task>& task, bool ok);
+    // A task that yielded, already switched back to Pending, goes back into
+    // this node's queue, still assigned here
+    void requeueYieldedTask(size_t slot, const std::shared_ptr<Task>& task);
+    // Publishes taskCount (to `load`) and isBusy() to the TaskManager's load
+    // index. Caller holds mtx, so reports from different threads stay in order.
+    void reportLoadLocked();
 };
\ No newline at end of file
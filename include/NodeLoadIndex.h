@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Indexed min-heap of node loads, ordered by (busy, load, node id), so the
+// least loaded node that can take work is always at the top.
+//
+// Nodes report their own entry (queued + running task count, and whether all
+// their slots are busy) whenever it changes, while holding their own lock;
+// schedulers read the top without touching any node. Every operation is
+// O(log N) under one short-held mutex, which is never held while calling out.
+class NodeLoadIndex {
+public:
+    void add(int nodeId);
+    void remove(int nodeId);
+    // Ignored for ids that are not in the index (e.g. a node being removed)
+    void update(int nodeId, int load, bool busy);
+
+    // Node id of the least loaded node that is not busy, or -1
+    int leastLoaded() const;
+    // Picks a node for each of `count` placements made together, counting
+    // the earlier picks as load (the nodes' own reports replace these
+    // estimates once the tasks are queued). Entries are -1 if every node is busy.
+    std::vector<int> reserve(size_t count);
+
+    size_t size() const;
+
+private:
+    struct Entry {
+        int nodeId;
+        int load;
+        bool busy;
+    };
+
+    mutable std::mutex mtx;
+    std::vector<Entry> heap;
+    // node id -> position in `heap`
+    std::unordered_map<int, size_t> positions;
+
+    static bool before(const Entry& a, const Entry& b);
+    void swapEntries(size_t a, size_t b);
+    void siftUp(size_t position);
+    void siftDown(size_t position);
+};
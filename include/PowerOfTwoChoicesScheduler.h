@@ -0,0 +1,23 @@
+#pragma once
+#include "Scheduler.h"
+#include <random>
+
+// Samples `choices` random nodes and picks the least loaded of them
+// (queued + running tasks, read without locking the node). With two choices
+// the busiest node stays within O(log log N) of the average, close to a
+// full least-loaded scan, at O(1) cost per placement.
+class PowerOfTwoChoicesScheduler : public Scheduler {
+private:
+    size_t choices;
+    std::minstd_rand rng;
+
+public:
+    explicit PowerOfTwoChoicesScheduler(size_t choices = 2);
+    int pickNode(const std::vector<std::shared_ptr<Node>>& nodes) override;
+    // Counts the tasks already picked for a node in this batch as its load
+    std::vector<int> pickNodes(const std::vector<std::shared_ptr<Node>>& nodes, size_t count) override;
+
+private:
+    // `extra` holds per-position load not yet visible on the nodes (may be empty)
+    int pick(const std::vector<std::shared_ptr<Node>>& nodes, const std::vector<int>& extra);
+};
@@ -4,9 +4,37 @@
 
 // Forward declarations to break circular dependencies
 class Node;
+class NodeLoadIndex;
+class Task;
 
 class Scheduler {
 public:
     virtual int pickNode(const std::vector<std::shared_ptr<Node>>& nodes) = 0;
+    
+    // Picks nodes for `count` tasks placed together; entry i is the node
+    // index for task i, or -1 if it has to wait. The default asks pickNode
+    // once per task. Schedulers whose choice depends on load should override
+    // it, since none of the picks is applied to the nodes until all are made.
+    virtual std::vector<int> pickNodes(const std::vector<std::shared_ptr<Node>>& nodes, size_t count) {
+        std::vector<int> picks;
+        picks.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            picks.push_back(pickNode(nodes));
+        }
+        return picks;
+    }
+    
+    // pickNodes for a known batch of tasks; schedulers that weigh tasks by
+    // their duration override this one. The default ignores the tasks.
+    virtual std::vector<int> pickNodesForTasks(const std::vector<std::shared_ptr<Node>>& nodes,
+                                               const std::vector<std::shared_ptr<Task>>& tasks) {
+        return pickNodes(nodes, tasks.size());
+    }
+    
+    // TaskManager hands every scheduler it installs the node load index it
+    // keeps current; schedulers that rank nodes by load can use it instead
+    // of asking each node. `nodes` is always sorted by node id.
+    virtual void setLoadIndex(NodeLoadIndex* /*index*/) {}
+    
     virtual ~Scheduler() = default;
 };
\ No newline at end of file
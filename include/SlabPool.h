@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// Fixed-size block allocator. Blocks are carved out of large slabs, so
+// objects allocated together sit together in memory, and freed blocks go on
+// a free list for reuse. Addresses are stable; slabs are only released when
+// the pool is destroyed.
+//
+// With threadCache set, each thread keeps up to 2 * kCacheBatch free blocks
+// of its own and moves them to and from the shared free list kCacheBatch at
+// a time, so most allocate/deallocate calls take no lock. Such a pool must
+// outlive every thread that uses it (the forSize pools are never destroyed).
+class SlabPool {
+public:
+    static constexpr size_t kCacheBatch = 32;
+
+    SlabPool(size_t blockSize, size_t blockAlign, size_t blocksPerSlab = 4096, bool threadCache = false);
+    ~SlabPool();
+
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    void* allocate();
+    void deallocate(void* block);
+
+    // Blocks handed out and not yet returned, counting those held in
+    // per-thread caches
+    size_t size() const;
+    // Bytes reserved from the system for slabs
+    size_t reservedBytes() const;
+
+    // The process-wide pool for blocks of this size and alignment. Never
+    // destroyed, so objects may be released during static destruction.
+    static SlabPool& forSize(size_t blockSize, size_t blockAlign);
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    // One thread's free blocks of one pool
+    struct CacheEntry {
+        SlabPool* pool = nullptr;
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+    };
+    struct ThreadCache;
+
+    mutable std::mutex mtx;
+    size_t blockSize;
+    size_t blockAlign;
+    size_t blocksPerSlab;
+    std::vector<void*> slabs;
+    FreeBlock* freeList;
+    // Unused tail of the newest slab
+    char* bumpNext;
+    char* bumpEnd;
+    size_t used;
+    bool threadCache;
+
+    // This thread's cache entry for the pool, or nullptr when the thread
+    // has no free cache slot left or is exiting
+    CacheEntry* cacheEntry();
+    // Caller holds mtx
+    void* takeLocked();
+    // Returns `count` blocks linked from first to last. Caller holds mtx.
+    void releaseLocked(FreeBlock* first, FreeBlock* last, size_t count);
+};
+
+// Allocator for std::allocate_shared: the object and its control block come
+// from one SlabPool block. Array allocations fall back to operator new.
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        if (n != 1) {
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T*>(pool().allocate());
+    }
+
+    void deallocate(T* p, size_t n) {
+        if (n != 1) {
+            ::operator delete(p);
+            return;
+        }
+        pool().deallocate(p);
+    }
+
+    static SlabPool& pool() {
+        static SlabPool& instance = SlabPool::forSize(sizeof(T), alignof(T));
+        return instance;
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) { return false; }
@@ -1,8 +1,37 @@
 #pragma once
 #include <string>
 #include <atomic>
+#include <memory>
+#include <chrono>
+#include <cstdint>
 
-enum class TaskStatus { Pending, Running, Completed };
+enum class TaskStatus : uint8_t { Pending, Running, Completed };
+// Order of the values is the order of urgency
+enum class TaskPriority : uint8_t { Low, Medium, High, Critical };
+// Which running tasks a node asks to yield when more urgent work waits:
+// none, only for Critical work, or for any higher priority
+enum class PreemptionPolicy { Off, Critical, HigherPriority };
+
+class Task;
+class TaskExecutor;
+
+// When a task went through each stage of its life, in microseconds on
+// Task::clockMicros()'s axis; 0 until the stage is reached
+struct TaskTimeline {
+    long long submitted = 0;
+    long long assigned = 0;  // latest assignment to a node
+    long long started = 0;   // first start; preemption does not reset it
+    long long finished = 0;
+};
+
+// Notified on every status transition of the tasks it is attached to.
+// Called on whichever thread changed the status, so implementations must be
+// thread-safe and cheap.
+class TaskObserver {
+public:
+    virtual ~TaskObserver() = default;
+    virtual void onStatusChange(const Task& task, TaskStatus from, TaskStatus to) = 0;
+};
 
 class Task {
 public:
@@ -18,14 +47,101 @@ public:
 
     int getId() const;
     std::string getName() const;
+    // The interned name; lives as long as the process
+    const std::string& getNameRef() const;
     int getDuration() const;
     TaskStatus getStatus() const;
 
     void setStatus(TaskStatus status);
+    // Sets the status only if it is still `expected`, in one atomic step;
+    // returns whether it did
+    bool compareAndSetStatus(TaskStatus expected, TaskStatus status);
+
+    // At most one observer; attach before the task is shared between threads
+    void setObserver(TaskObserver* observer);
+
+    // What running the task does; set before the task is queued.
+    // Without one the task sleeps for its duration.
+    void setExecutor(std::shared_ptr<TaskExecutor> executor);
+    std::shared_ptr<TaskExecutor> getExecutor() const;
+
+    // Earliest start as Unix time in milliseconds; 0 (the default) means as
+    // soon as a node is free. Set before the task is shared.
+    void setRunAt(long long runAt);
+    long long getRunAt() const;
+
+    // Queue ordering among waiting tasks (see TaskQueue); Medium by default.
+    // Set before the task is shared.
+    void setPriority(TaskPriority priority);
+    TaskPriority getPriority() const;
+
+    // Runs the executor on the calling thread and records the outcome
+    bool execute();
+    bool hasFailed() const;
+    // Records a failure without running the task
+    void markFailed();
+
+    // Cooperative preemption. A preemptible executor (see TaskExecutor)
+    // notices requestYield() through isYieldRequested() or
+    // waitForYieldRequest(), calls yieldAt() with how far it got and returns;
+    // the next execute() resumes from getCheckpoint(). The request is
+    // cleared when execute() returns.
+    void requestYield();
+    bool isYieldRequested() const;
+    // Blocks for up to `timeout`; true as soon as a yield is requested
+    bool waitForYieldRequest(std::chrono::milliseconds timeout) const;
+    // Executor-defined progress; 0 starts the work over
+    void yieldAt(long long checkpoint);
+    long long getCheckpoint() const;
+    // True if the last execute() stopped early on a yield request
+    bool hasYielded() const;
+    int getPreemptionCount() const;
+
+    // Lifecycle timestamps. Submitted is stamped when the task is created,
+    // started on its first move to Running and finished on the move to
+    // Completed (before observers hear of it); whoever queues the task on a
+    // node calls markAssigned().
+    TaskTimeline getTimeline() const;
+    void markAssigned();
+    // Restores timestamps loaded from the database
+    void setTimeline(const TaskTimeline& timeline);
+    // A monotonic clock in microseconds, offset once at startup to read as
+    // Unix time, so stored timestamps stay comparable across restarts
+    static long long clockMicros();
+
+    // Opaque to Task: TaskManager records which scheduler placed the task
+    void setSchedulerTag(uint8_t tag);
+    uint8_t getSchedulerTag() const;
+    // Also TaskManager's: whether the task sits in its ready queue, guarded
+    // by the TaskManager's lock
+    void setInReadyQueue(bool queued);
+    bool isInReadyQueue() const;
 
 private:
+    // Ordered to keep the object small; tasks are kept by the million
     int id;
-    std::string name;
     int duration;
     std::atomic<TaskStatus> status;
+    TaskPriority priority;
+    std::atomic<bool> failed;
+    std::atomic<bool> yieldRequested;
+    // Written by the thread running the task
+    bool yielded;
+    uint8_t schedulerTag;
+    bool inReadyQueue;
+    std::atomic<int> preemptions;
+    // Interned: tasks with the same name share one string
+    const std::string* name;
+    TaskObserver* observer;
+    std::shared_ptr<TaskExecutor> executor;
+    long long runAt;
+    long long checkpoint;
+    std::atomic<long long> submittedAt;
+    std::atomic<long long> assignedAt;
+    std::atomic<long long> startedAt;
+    std::atomic<long long> finishedAt;
 };
+
+// Creates a task in the shared task pool (see SlabPool): the task and its
+// reference count take one pooled block instead of a heap allocation
+std::shared_ptr<Task> makeTask(int id, const std::string& name, int duration);
@@ -0,0 +1,35 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include "Task.h"
+
+// Live task totals per status, kept in memory so stats can be read without
+// querying SQLite. Updates land in a per-thread slot (one cache line each)
+// and reads sum the slots, so worker threads changing statuses never write
+// to the same line. Individual slots may go negative; only the sums matter.
+class TaskCounters : public TaskObserver {
+public:
+    // slotCount 0 picks one slot per hardware thread
+    explicit TaskCounters(size_t slotCount = 0);
+
+    // A task entered the table with the given status
+    void onTaskAdded(TaskStatus status);
+    void onStatusChange(const Task& task, TaskStatus from, TaskStatus to) override;
+
+    long long getTotal() const;
+    long long getCount(TaskStatus status) const;
+
+private:
+    static constexpr size_t kStatusCount = 3;
+
+    struct alignas(64) Slot {
+        std::atomic<long long> total{0};
+        std::atomic<long long> byStatus[kStatusCount] = {};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t slotCount;
+
+    Slot& localSlot();
+};
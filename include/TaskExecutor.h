@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+class Task;
+
+// Runs the work behind a task. execute() is called on one of a node's
+// executor slots, blocks until the work is done and reports success.
+// Tasks without an executor fall back to SleepExecutor.
+class TaskExecutor {
+public:
+    virtual ~TaskExecutor() = default;
+    virtual bool execute(Task& task) = 0;
+    // True if execute() stops early, through Task::yieldAt(), once the task
+    // is asked to yield; only these tasks are ever preempted
+    virtual bool isPreemptible() const { return false; }
+    // Kind name and payload are what gets persisted with the task;
+    // makeExecutor() turns them back into an executor
+    virtual std::string kind() const = 0;
+    virtual std::string payload() const { return ""; }
+};
+
+// Simulated work: sleeps for the task's duration in seconds. Preemptible;
+// the checkpoint is the time already slept, in ms.
+class SleepExecutor : public TaskExecutor {
+public:
+    bool execute(Task& task) override;
+    bool isPreemptible() const override { return true; }
+    std::string kind() const override { return "sleep"; }
+};
+
+// In-process work supplied by the caller. Not restorable from the
+// database: a reloaded task of this kind that had not finished is marked
+// failed and Completed.
+class CallableExecutor : public TaskExecutor {
+public:
+    explicit CallableExecutor(std::function<bool()> work);
+    bool execute(Task& task) override;
+    std::string kind() const override { return "callable"; }
+
+private:
+    std::function<bool()> work;
+};
+
+// Synthetic CPU-bound kernel: `iterations` rounds of integer mixing.
+// Preemptible; the checkpoint is the number of rounds done.
+class CpuExecutor : public TaskExecutor {
+public:
+    explicit CpuExecutor(uint64_t iterations);
+    bool execute(Task& task) override;
+    bool isPreemptible() const override { return true; }
+    std::string kind() const override { return "cpu"; }
+    std::string payload() const override { return std::to_string(iterations); }
+
+private:
+    uint64_t iterations;
+};
+
+// External command run through /bin/sh; succeeds on exit status 0
+class CommandExecutor : public TaskExecutor {
+public:
+    explicit CommandExecutor(const std::string& command);
+    bool execute(Task& task) override;
+    std::string kind() const override { return "command"; }
+    std::string payload() const override { return command; }
+
+private:
+    std::string command;
+};
+
+// Builds an executor from a persisted/submitted kind and payload. Returns
+// nullptr for an unknown kind, an invalid payload, or "callable".
+std::shared_ptr<TaskExecutor> makeExecutor(const std::string& kind, const std::string& payload);
@@ -0,0 +1,82 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+#include "Task.h"
+
+// Queue of waiting tasks ordered by priority: one FIFO deque per
+// TaskPriority level, popped from the highest non-empty level.
+//
+// Waiting tasks age: a task that has sat at one level for agingInterval
+// moves up to the next, so Low work reaches Critical after three intervals
+// and is never starved by a steady stream of urgent tasks. Aging is applied
+// lazily on pop. With shortest-job-first on, each level is ordered by
+// duration instead of arrival; either way a level also keeps its tasks in
+// the order they reached it, so aging only ever looks at the oldest.
+//
+// Not synchronized; the owner (a Node or TaskManager) guards it.
+class TaskQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::milliseconds kDefaultAgingInterval{5000};
+
+    explicit TaskQueue(std::chrono::milliseconds agingInterval = kDefaultAgingInterval);
+    // Entries and arrivals point at each other
+    TaskQueue(const TaskQueue&) = delete;
+    TaskQueue& operator=(const TaskQueue&) = delete;
+
+    // Zero or negative turns aging off
+    void setAgingInterval(std::chrono::milliseconds interval);
+    void setShortestJobFirst(bool enabled);
+
+    void push(const std::shared_ptr<Task>& task);
+    // Most urgent task, or nullptr when empty
+    std::shared_ptr<Task> pop();
+    // Least urgent task (what work stealing takes), or nullptr when empty
+    std::shared_ptr<Task> popLeastUrgent();
+    // Removes and returns everything, most urgent first
+    std::vector<std::shared_ptr<Task>> takeAll();
+    // Current contents, most urgent first
+    std::vector<std::shared_ptr<Task>> snapshot() const;
+
+    // Level of the most urgent waiting task, aging as of the last pop;
+    // Low when empty
+    TaskPriority topPriority() const;
+
+    bool empty() const;
+    size_t size() const;
+
+private:
+    static constexpr int kLevels = 4;
+
+    struct Arrival;
+    struct Entry {
+        std::shared_ptr<Task> task;
+        std::list<Arrival>::iterator arrival;
+    };
+    // Keyed by duration with shortest-job-first on, else all 0; equal keys
+    // keep insertion order
+    using Queue = std::multimap<int, Entry>;
+    struct Arrival {
+        Clock::time_point since;  // when the task entered this level
+        Queue::iterator entry;
+    };
+    struct Level {
+        Queue queue;
+        std::list<Arrival> arrivals;  // oldest first
+    };
+
+    Level levels[kLevels];
+    size_t count;
+    std::chrono::milliseconds agingInterval;
+    bool shortestJobFirst;
+
+    void insert(int level, std::shared_ptr<Task> task, Clock::time_point since);
+    std::shared_ptr<Task> take(int level, Queue::iterator entry);
+    // Moves every entry that waited agingInterval at its level up one level
+    void age(Clock::time_point now);
+};
@@ -0,0 +1,98 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Hierarchical timing wheel: millisecond resolution, O(1) schedule and cancel.
+//
+// Four wheels of 256 slots each cover 1 ms, 256 ms, ~65 s and ~4.6 h per
+// slot (about 49 days in all; later deadlines park in the last slot and are
+// re-filed when it comes round). A timer is linked into the slot of the
+// coarsest wheel it needs; when a slot of an outer wheel comes due, its timers
+// cascade down into the finer wheels, so each timer is touched at most once
+// per level. Timers live in a slab indexed by TimerId, so cancel unlinks in
+// place without searching.
+//
+// One thread drives the wheels. It sleeps until the next occupied slot
+// (found through per-wheel occupancy bitmaps) instead of ticking, so armed
+// timers cost nothing while they wait. Callbacks run on that thread, outside
+// the wheel's lock; they should be short and hand real work elsewhere.
+class TimingWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    // 0 is never a valid id
+    using TimerId = std::uint64_t;
+
+    TimingWheel();
+    ~TimingWheel();
+
+    TimingWheel(const TimingWheel&) = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    void start();
+    // Timers still armed stay armed (and never fire) until destruction
+    void stop();
+
+    TimerId schedule(std::chrono::milliseconds delay, Callback callback);
+    TimerId scheduleAt(Clock::time_point when, Callback callback);
+
+    // Returns false if the timer already fired, is firing, or was cancelled
+    bool cancel(TimerId id);
+
+    // Timers armed and not yet fired
+    size_t size() const;
+
+private:
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 8;
+    static constexpr int kSlots = 1 << kSlotBits;
+    static constexpr int kWords = kSlots / 64;
+    // Bucket holding timers that are already due
+    static constexpr int kDueBucket = kLevels * kSlots;
+
+    struct Timer {
+        long long deadline;      // tick (ms since `epoch`)
+        Callback callback;
+        std::int32_t prev;
+        std::int32_t next;       // also links the free list
+        std::int32_t bucket;     // -1 while free
+        std::uint32_t generation;
+    };
+
+    Clock::time_point epoch;
+    // Last tick processed; every armed timer is due after it (or is in the due bucket)
+    long long currentTick;
+
+    mutable std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<Timer> timers;
+    std::int32_t freeList;
+    std::int32_t heads[kDueBucket + 1];
+    std::uint64_t occupied[kLevels][kWords];
+    size_t armed;
+    // Tick the worker sleeps until; -1 while it is awake
+    long long plannedWake;
+    bool running;
+    std::thread worker;
+
+    long long tickOf(Clock::time_point when) const;
+    void run();
+
+    std::int32_t allocateLocked(long long deadline, Callback callback);
+    void releaseLocked(std::int32_t index);
+    void linkLocked(std::int32_t index);
+    void unlinkLocked(std::int32_t index);
+    // Detaches the bucket and returns its first timer
+    std::int32_t takeBucketLocked(int bucket);
+
+    // Earliest tick after currentTick at which a slot comes due; -1 if none
+    long long nextEventTickLocked() const;
+    // Processes every slot due up to `now` and moves the fired callbacks to `out`
+    void advanceLocked(long long now, std::vector<Callback>& out);
+    void processTickLocked(long long tick);
+};
@@ -2,9 +2,18 @@
 #define LOGGING_SERVICE_H
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include <deque>
 #include <fstream>
 #include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <condition_variable>
+#include <charconv>
+#include <sstream>
+#include <type_traits>
 
 // Log levels in increasing order of severity
 enum class LogLevel {
@@ -15,47 +24,202 @@ enum class LogLevel {
     CRITICAL
 };
 
+// The same levels as plain numbers, for LOG_COMPILED_LEVEL
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_CRITICAL 4
+
+// LOG_* calls below this level compile to nothing. Debug builds keep every
+// level; builds with NDEBUG drop LOG_DEBUG. Override with
+// -DLOG_COMPILED_LEVEL=LOG_LEVEL_WARNING and so on.
+#ifndef LOG_COMPILED_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILED_LEVEL LOG_LEVEL_INFO
+#else
+#define LOG_COMPILED_LEVEL LOG_LEVEL_DEBUG
+#endif
+#endif
+
 // Singleton logger class
+//
+// By default every call formats, prints and flushes the line on the
+// caller's thread. In async mode (setAsync) a call only copies the message
+// into a fixed-size record in a ring buffer owned by the calling thread;
+// a background thread formats and writes the records in batches, with one
+// flush per batch. Messages longer than a record are truncated, and records
+// are dropped (and counted) if a thread outruns the writer.
 class LoggingService {
 private:
+    struct Record;
+    struct Ring;
+
     static LoggingService* instance;
-    
-    std::vector<std::string> logs;
+
+    // The newest historyCapacity lines
+    std::deque<std::string> logs;
+    size_t historyCapacity;
     std::ofstream logFile;
-    LogLevel minLevel;
+    std::atomic<LogLevel> minLevel;
     mutable std::mutex logMutex;  // Add this line to declare the mutex
-    
+
+    // Async mode
+    std::atomic<bool> async;
+    size_t ringCapacity;
+    std::mutex ringsMutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::atomic<unsigned long long> dropped;
+    // Drops already reported in the log (guarded by drainMutex)
+    unsigned long long droppedReported;
+    // Held by whichever thread is draining the rings
+    std::mutex drainMutex;
+    std::thread writer;
+    std::mutex writerMutex;
+    std::condition_variable writerCv;
+    bool stopWriter;
+    // Formatted timestamp cache for the writer (guarded by drainMutex)
+    long long cachedSecond;
+    std::string cachedStamp;
+
     // Private constructor for singleton
     LoggingService();
-    
+
+    Ring* localRing();
+    void writerLoop();
+    // "YYYY-mm-dd HH:MM:SS" for a system_clock time. Caller holds drainMutex.
+    const std::string& stampLocked(long long micros);
+    // Formats and writes everything queued so far. Caller holds drainMutex.
+    void drainLocked();
+    // Adds lines to the bounded history. Caller holds logMutex.
+    void rememberLocked(std::string line);
+    static const char* levelName(LogLevel level);
+    // Per-thread scratch string that logArgs formats into
+    static std::string& formatBuffer();
+
+    template <typename T>
+    static void appendArg(std::string& out, const T& value) {
+        if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            out.append(std::string_view(value));
+        } else if constexpr (std::is_same_v<T, char>) {
+            out.push_back(value);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            out.append(value ? "true" : "false");
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            char digits[32];
+            auto result = std::to_chars(digits, digits + sizeof(digits), value);
+            out.append(digits, result.ptr);
+        } else {
+            std::ostringstream stream;
+            stream << value;
+            out.append(stream.str());
+        }
+    }
+
 public:
+    static constexpr size_t kDefaultHistoryCapacity = 10000;
+    static constexpr size_t kDefaultRingCapacity = 1024;
+
     // Delete copy constructor and assignment operator
     LoggingService(const LoggingService&) = delete;
     LoggingService& operator=(const LoggingService&) = delete;
-    
+
     // Destructor
     ~LoggingService();
-    
+
     // Get singleton instance
     static LoggingService* getInstance();
-    
+
     // Log methods
-    void log(LogLevel level, const std::string& message);
-    void debug(const std::string& message);
-    void info(const std::string& message);
-    void warning(const std::string& message);
-    void error(const std::string& message);
-    void critical(const std::string& message);
-    
+    void log(LogLevel level, std::string_view message);
+    void debug(std::string_view message);
+    void info(std::string_view message);
+    void warning(std::string_view message);
+    void error(std::string_view message);
+    void critical(std::string_view message);
+
+    // Whether a message at this level would be logged; the LOG_* macros
+    // check this before evaluating their arguments
+    bool isEnabled(LogLevel level) const {
+        return level >= minLevel.load(std::memory_order_relaxed);
+    }
+
+    // Logs the arguments concatenated: strings and characters as they are,
+    // numbers via std::to_chars, anything else via operator<<. Reuses a
+    // per-thread buffer, so an enabled call allocates nothing once warm.
+    template <typename... Args>
+    void logArgs(LogLevel level, const Args&... args) {
+        std::string& buffer = formatBuffer();
+        buffer.clear();
+        (appendArg(buffer, args), ...);
+        log(level, buffer);
+    }
+
     // Configuration
     void setMinLogLevel(LogLevel level);
     void setLogFile(const std::string& filename);
-    
+    // Switches async mode on or off. Turning it off writes out whatever is
+    // still queued. ringCapacity (records per thread, rounded up to a power
+    // of two) applies to threads that log for the first time afterwards.
+    void setAsync(bool enabled, size_t ringCapacity = kDefaultRingCapacity);
+    bool isAsync() const;
+    void setHistoryCapacity(size_t capacity);
+    // Async mode: writes out everything logged before the call
+    void flush();
+    // Async mode: records lost because a thread's ring was full
+    unsigned long long getDroppedCount() const;
+
     // Retrieval
     std::vector<std::string> getRecentLogs(int count) const;
-    
+
     // Management
     void clearLogs();
 };
 
-#endif // LOGGING_SERVICE_H
\ No newline at end of file
+// Logging macros. The arguments are only evaluated (and formatted) when the
+// level is enabled at run time, and calls below LOG_COMPILED_LEVEL are
+// removed entirely:
+//   LOG_DEBUG("Task ID: ", task->getId(), " added to Node ", id);
+#define LOG_AT(level, ...) \
+    do { \
+        LoggingService* logService_ = LoggingService::getInstance(); \
+        if (logService_->isEnabled(level)) { \
+            logService_->logArgs(level, __VA_ARGS__); \
+        } \
+    } while (0)
+
+// Still type-checks the arguments, but generates no code
+#define LOG_DISCARD(...) \
+    do { \
+        if (false) { \
+            LoggingService::getInstance()->logArgs(LogLevel::DEBUG, __VA_ARGS__); \
+        } \
+    } while (0)
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) LOG_AT(LogLevel::DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LOG_DISCARD(__VA_ARGS__)
+#endif
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(...) LOG_AT(LogLevel::INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) LOG_DISCARD(__VA_ARGS__)
+#endif
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_WARNING(...) LOG_AT(LogLevel::WARNING, __VA_ARGS__)
+#else
+#define LOG_WARNING(...) LOG_DISCARD(__VA_ARGS__)
+#endif
+
+#if LOG_COMPILED_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) LOG_AT(LogLevel::ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) LOG_DISCARD(__VA_ARGS__)
+#endif
+
+#define LOG_CRITICAL(...) LOG_AT(LogLevel::CRITICAL, __VA_ARGS__)
+
+#endif // LOGGING_SERVICE_H
@@ -3,70 +3,388 @@
 
 #include <string>
 #include <queue>
+#include <vector>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+// Queue implementations selectable through the second template argument
+namespace Policy {
+    // Unbounded std::queue guarded by a mutex and condition variable
+    struct Mutex {};
+    // Bounded lock-free ring buffer (multi-producer, multi-consumer)
+    struct LockFree {};
+}
 
 // Template for message types
-template <typename T>
+template <typename T, typename QueuePolicy = Policy::Mutex>
 class MessageQueue {
 private:
     std::queue<T> queue;
-    std::mutex mtx;
+    mutable std::mutex mtx;
     std::condition_variable cv;
     bool closed;
-    
+
 public:
     MessageQueue() : closed(false) {}
-    
+
     // Close the queue, no more messages will be accepted
     void close() {
         std::lock_guard<std::mutex> lock(mtx);
         closed = true;
         cv.notify_all();
     }
-    
+
     // Check if queue is closed
     bool isClosed() const {
         std::lock_guard<std::mutex> lock(mtx);
         return closed;
     }
-    
+
     // Add message to queue
     bool send(const T& message) {
         std::lock_guard<std::mutex> lock(mtx);
         if (closed) return false;
-        
+
         queue.push(message);
         cv.notify_one();
         return true;
     }
-    
+
+    bool send(T&& message) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (closed) return false;
+
+        queue.push(std::move(message));
+        cv.notify_one();
+        return true;
+    }
+
+    // Add several messages under one lock; returns how many were accepted
+    size_t sendBatch(std::vector<T>& messages) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (closed) return 0;
+
+        for (auto& message : messages) {
+            queue.push(std::move(message));
+        }
+        cv.notify_all();
+        return messages.size();
+    }
+
     bool receive(T& message, bool wait = true) {
         std::unique_lock<std::mutex> lock(mtx);
-        
+
         if (wait) {
             cv.wait(lock, [this] { return !queue.empty() || closed; });
         }
-        
+
         if (queue.empty()) return false;
-        
-        message = queue.front();
+
+        message = std::move(queue.front());
         queue.pop();
         return true;
     }
-    
+
+    // Wait at most `timeout` for a message
+    template <typename Rep, typename Period>
+    bool receiveFor(T& message, std::chrono::duration<Rep, Period> timeout) {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait_for(lock, timeout, [this] { return !queue.empty() || closed; });
+
+        if (queue.empty()) return false;
+
+        message = std::move(queue.front());
+        queue.pop();
+        return true;
+    }
+
+    // Append up to maxMessages to `out`; returns how many were received
+    size_t receiveBatch(std::vector<T>& out, size_t maxMessages, bool wait = true) {
+        std::unique_lock<std::mutex> lock(mtx);
+
+        if (wait) {
+            cv.wait(lock, [this] { return !queue.empty() || closed; });
+        }
+
+        size_t count = 0;
+        while (count < maxMessages && !queue.empty()) {
+            out.push_back(std::move(queue.front()));
+            queue.pop();
+            count++;
+        }
+        return count;
+    }
+
     // Check if queue is empty
     bool isEmpty() const {
         std::lock_guard<std::mutex> lock(mtx);
         return queue.empty();
     }
-    
+
     size_t size() const {
         std::lock_guard<std::mutex> lock(mtx);
         return queue.size();
     }
 };
 
+// Bounded MPMC ring buffer (Vyukov's sequence-numbered cells). Producers and
+// consumers claim slots with a CAS on their own cursor and never share a lock.
+// Blocking calls spin briefly and then park on a condition variable; the park
+// mutex is only touched when someone is actually waiting.
+template <typename T>
+class MessageQueue<T, Policy::LockFree> {
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    static constexpr size_t kCacheLine = 64;
+    static constexpr int kSpinCount = 128;
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(kCacheLine) std::atomic<size_t> enqueuePos;
+    alignas(kCacheLine) std::atomic<size_t> dequeuePos;
+    alignas(kCacheLine) std::atomic<bool> closed;
+
+    // Parking for blocked producers/consumers
+    std::atomic<int> waitingConsumers;
+    std::atomic<int> waitingProducers;
+    std::mutex parkMtx;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+
+    static size_t roundUpPowerOfTwo(size_t n) {
+        size_t capacity = 2;
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
+
+    template <typename U>
+    bool tryPush(U&& message) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    new (&cell.storage) T(std::forward<U>(message));
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(T& message) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells[pos & mask];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    T* item = reinterpret_cast<T*>(&cell.storage);
+                    message = std::move(*item);
+                    item->~T();
+                    cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // Empty
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Wake one parked thread on the other side, if there is one. The fence
+    // pairs with the one in parkUntil so a waiter can't miss this item.
+    void wake(std::atomic<int>& waiters, std::condition_variable& cv, bool all = false) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(parkMtx);
+            if (all) cv.notify_all(); else cv.notify_one();
+        }
+    }
+
+    // Spin on `attempt` for a while, then park on `cv` until it succeeds,
+    // the queue closes, or the deadline passes
+    template <typename Attempt>
+    bool parkUntil(Attempt attempt, std::atomic<int>& waiters, std::condition_variable& cv,
+                   const std::chrono::steady_clock::time_point* deadline) {
+        for (int i = 0; i < kSpinCount; ++i) {
+            if (attempt()) return true;
+            if (closed.load(std::memory_order_acquire)) return attempt();
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(parkMtx);
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool done = false;
+        while (!(done = attempt()) && !closed.load(std::memory_order_acquire)) {
+            if (deadline) {
+                if (cv.wait_until(lock, *deadline) == std::cv_status::timeout) {
+                    done = attempt();
+                    break;
+                }
+            } else {
+                cv.wait(lock);
+            }
+        }
+        if (!done && closed.load(std::memory_order_acquire)) done = attempt();
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+        return done;
+    }
+
+public:
+    // Capacity is rounded up to a power of two
+    explicit MessageQueue(size_t capacity = 1024)
+        : cells(new Cell[roundUpPowerOfTwo(capacity)]),
+          mask(roundUpPowerOfTwo(capacity) - 1),
+          enqueuePos(0), dequeuePos(0), closed(false),
+          waitingConsumers(0), waitingProducers(0) {
+        for (size_t i = 0; i <= mask; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MessageQueue() {
+        // Destroy whatever was never received
+        size_t tail = enqueuePos.load(std::memory_order_relaxed);
+        for (size_t pos = dequeuePos.load(std::memory_order_relaxed); pos != tail; ++pos) {
+            reinterpret_cast<T*>(&cells[pos & mask].storage)->~T();
+        }
+    }
+
+    MessageQueue(const MessageQueue&) = delete;
+    MessageQueue& operator=(const MessageQueue&) = delete;
+
+    // Close the queue, no more messages will be accepted
+    void close() {
+        closed.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(parkMtx);
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+    bool isClosed() const {
+        return closed.load(std::memory_order_acquire);
+    }
+
+    // Add message to queue, waiting for space while the ring is full
+    bool send(const T& message) {
+        return sendImpl(message);
+    }
+
+    bool send(T&& message) {
+        return sendImpl(std::move(message));
+    }
+
+    // Non-blocking send; fails when the ring is full or closed
+    bool trySend(T message) {
+        if (closed.load(std::memory_order_acquire)) return false;
+        if (!tryPush(std::move(message))) return false;
+        wake(waitingConsumers, notEmpty);
+        return true;
+    }
+
+    // Add several messages with a single wakeup; returns how many were accepted
+    size_t sendBatch(std::vector<T>& messages) {
+        size_t sent = 0;
+        for (auto& message : messages) {
+            if (closed.load(std::memory_order_acquire)) break;
+            if (!tryPush(std::move(message))) {
+                wake(waitingConsumers, notEmpty, true);
+                // parkUntil retries once more after a close; that retry must not push
+                if (!parkUntil([&] { return !closed.load(std::memory_order_acquire) &&
+                                            tryPush(std::move(message)); },
+                               waitingProducers, notFull, nullptr)) {
+                    break;
+                }
+            }
+            sent++;
+        }
+        if (sent > 0) wake(waitingConsumers, notEmpty, true);
+        return sent;
+    }
+
+    bool receive(T& message, bool wait = true) {
+        bool received = wait
+            ? parkUntil([&] { return tryPop(message); }, waitingConsumers, notEmpty, nullptr)
+            : tryPop(message);
+        if (received) wake(waitingProducers, notFull);
+        return received;
+    }
+
+    // Wait at most `timeout` for a message
+    template <typename Rep, typename Period>
+    bool receiveFor(T& message, std::chrono::duration<Rep, Period> timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        bool received = parkUntil([&] { return tryPop(message); }, waitingConsumers, notEmpty, &deadline);
+        if (received) wake(waitingProducers, notFull);
+        return received;
+    }
+
+    // Append up to maxMessages to `out`; returns how many were received.
+    // Requires T to be default constructible.
+    size_t receiveBatch(std::vector<T>& out, size_t maxMessages, bool wait = true) {
+        if (maxMessages == 0) return 0;
+
+        T message;
+        if (!receive(message, wait)) return 0;
+        out.push_back(std::move(message));
+
+        size_t count = 1;
+        while (count < maxMessages && tryPop(message)) {
+            out.push_back(std::move(message));
+            count++;
+        }
+        wake(waitingProducers, notFull, true);
+        return count;
+    }
+
+    // Approximate under concurrent use
+    bool isEmpty() const {
+        return size() == 0;
+    }
+
+    size_t size() const {
+        size_t head = dequeuePos.load(std::memory_order_acquire);
+        size_t tail = enqueuePos.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    template <typename U>
+    bool sendImpl(U&& message) {
+        if (closed.load(std::memory_order_acquire)) return false;
+
+        bool sent = tryPush(std::forward<U>(message)) ||
+            parkUntil([&] { return !closed.load(std::memory_order_acquire) && tryPush(std::forward<U>(message)); },
+                      waitingProducers, notFull, nullptr);
+        if (sent) wake(waitingConsumers, notEmpty);
+        return sent;
+    }
+};
+
 // Specialization for string messages
 using StringMessageQueue = MessageQueue<std::string>;
 
@@ -2,10 +2,21 @@
 #define TASKMANAGER_H
 
 #include "Task.h"
+#include "TaskCounters.h"
+#include "ChangeLog.h"
+#include "TimingWheel.h"
+#include "NodeLoadIndex.h"
+#include "TaskQueue.h"
+#include "Metrics.h"
+#include <chrono>
 #include <memory>
 #include <mutex>
+#include <atomic>
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <set>
+#include <optional>
 
 // Forward declarations
 class Node;
@@ -13,44 +24,129 @@ class Scheduler;
 class FIFOScheduler;
 class RoundRobinScheduler;
 class LoadBalancedScheduler;
+class PowerOfTwoChoicesScheduler;
+class LeastWorkScheduler;
 class DatabaseManager;
 
 enum class SchedulerType { 
     FIFO, 
     RoundRobin, 
-    LoadBalanced 
+    LoadBalanced,
+    PowerOfTwoChoices,
+    LeastWork
 };
+constexpr size_t kSchedulerTypeCount = 5;
 
-class TaskManager {
+// Parameters for one task in a bulk submission
+struct TaskSpec {
+    std::string name;
+    int duration;
+    std::shared_ptr<TaskExecutor> executor;  // nullptr: sleep for `duration`
+    TaskPriority priority = TaskPriority::Medium;
+    long long runAt = 0;  // as for TaskManager::addTask
+};
+
+// One page of a keyset-paginated task listing. nextAfterId is the cursor for
+// the following page, or -1 when this page reached the end.
+struct TaskPage {
+    std::vector<std::shared_ptr<Task>> tasks;
+    int nextAfterId = -1;
+};
+
+// Task state is partitioned into shards by task id, each with its own lock,
+// so task creation and lookups from different threads rarely contend. The
+// node list, scheduler and ready queue (everything placement needs) sit
+// behind a separate, short-held mutex.
+class TaskManager : private TaskObserver {
 public:
-    TaskManager(std::unique_ptr<Scheduler> scheduler, const std::string& dbPath = "taskmaster.db");
+    TaskManager(std::unique_ptr<Scheduler> scheduler, const std::string& dbPath = "taskmaster.db",
+                size_t taskShardCount = 16);
     ~TaskManager();
 
     // Initialization
     bool initialize();
 
-    // Task management
-    void addTask(const std::string& name, int duration);
+    // Task management; both return the new task ids.
+    // runAt: Unix time in ms before which the task is not placed on a node;
+    // until then it stays Pending on a timer (see TimingWheel). 0 or a time
+    // already past places it right away.
+    // priority: waiting tasks are taken most urgent first, by the ready
+    // queue and by every node (see TaskQueue)
+    int addTask(const std::string& name, int duration,
+                std::shared_ptr<TaskExecutor> executor = nullptr, long long runAt = 0,
+                TaskPriority priority = TaskPriority::Medium);
+    // Bulk submission: one id block, one lock per shard, one scheduler call
+    // under one scheduling lock, and one database job for the whole batch.
+    // Tasks whose runAt is still ahead skip the scheduler and wait on a timer.
+    std::vector<int> addTasks(const std::vector<TaskSpec>& specs);
+    // Largest batch the HTTP API hands to addTasks
+    static constexpr size_t kMaxBatchSize = 100000;
     
     // Node management
-    void addNode();
+    // slots: executor slots (tasks run concurrently) on the new node,
+    // 0 for the default set with setDefaultNodeSlots (initially 1)
+    int addNode(size_t slots = 0);
+    void setDefaultNodeSlots(size_t slots);
+    // Whether command tasks saved before a restart may run (off by default).
+    // Call before initialize(); see DatabaseManager::setAllowCommands.
+    void setAllowCommands(bool allow);
     void removeNode(int id);
     
     // Scheduler management
     void setScheduler(SchedulerType type);
     SchedulerType getCurrentSchedulerType() const;
     std::string getCurrentSchedulerName() const;
+    // Shortest-job-first ordering of every node's local queue (default off)
+    void setShortestJobFirst(bool enabled);
+    bool isShortestJobFirst() const;
+    // Wait after which a queued task moves up one priority level, for the
+    // ready queue and every node; zero turns aging off
+    void setPriorityAging(std::chrono::milliseconds interval);
+    std::chrono::milliseconds getPriorityAging() const;
+    // Cooperative preemption of running tasks when more urgent work waits,
+    // on a node or in the ready queue (see Node::preemptFor). budget caps
+    // how often one task is preempted. Off by default.
+    void setPreemption(PreemptionPolicy policy, int budget = kDefaultPreemptionBudget);
+    PreemptionPolicy getPreemptionPolicy() const;
+    int getPreemptionBudget() const;
+    static constexpr int kDefaultPreemptionBudget = 3;
     
     // Getters for tasks and nodes
     std::vector<std::shared_ptr<Task>> getAllTasks() const;
+    // Up to `limit` tasks with id > afterId in id order, optionally only
+    // those currently in `status`. Cost depends on the page, not the table,
+    // except for Completed pages, which step over the unfinished tasks.
+    TaskPage getTasksPage(int afterId, size_t limit,
+                          std::optional<TaskStatus> status = std::nullopt) const;
     std::vector<std::shared_ptr<Node>> getAllNodes() const;
     std::vector<std::string> getAllNodesInfo() const;
-    mutable std::mutex mtx;
+    
+    // Id lookups, O(1) through the indexes below
+    std::shared_ptr<Task> getTask(int taskId) const;
+    std::shared_ptr<Node> getNode(int nodeId) const;
+    
     // Task assignment
     bool assignTaskToNode(int taskId, int nodeId);
-    std::vector<std::shared_ptr<Task>> tasks;
-    std::vector<std::shared_ptr<Node>> nodes;
-    std::unique_ptr<Scheduler> scheduler;
+    
+    // Ready queue of tasks that could not be placed on a node yet.
+    // Nodes call dispatchPendingTask() when they free up; it places at most
+    // one waiting task and returns whether it did.
+    bool dispatchPendingTask();
+    size_t getBacklogDepth() const;
+    // Tasks waiting for their run_at time
+    size_t getScheduledTaskCount() const;
+    
+    // Idle nodes steal queued work from busy peers when enabled (default on)
+    void setWorkStealing(bool enabled);
+    bool isWorkStealingEnabled() const;
+    
+    // Load of every listed node, reported by the nodes themselves and read
+    // by load-aware schedulers
+    NodeLoadIndex& getLoadIndex() { return loadIndex; }
+    
+    // Current node list, published without taking a lock (read by stealing nodes)
+    std::shared_ptr<const std::vector<std::shared_ptr<Node>>> getNodeSnapshot() const;
+    
     // Task status updates
     bool cancelTask(int taskId);
     bool pauseTask(int taskId);
@@ -59,22 +155,147 @@ public:
     // Database operations
     std::shared_ptr<DatabaseManager> getDbManager() { return dbManager; }
     
-    // Database statistics
+    // Versioned feed of task/node mutations (creation, status, assignment,
+    // node add/remove) for clients polling by version
+    ChangeLog& getChangeLog() { return changeLog; }
+    
+    // Statistics, served from in-memory counters (see TaskCounters); the
+    // DatabaseManager getters of the same name remain for cross-checking
     int getTotalTaskCount() const;
     int getPendingTaskCount() const;
     int getRunningTaskCount() const;
     int getCompletedTaskCount() const;
     int getTotalNodeCount() const;
+    // Task, ready queue, per-node, scheduler and database metrics in the
+    // Prometheus text format
+    void writeMetrics(MetricsWriter& out) const;
+    
+    // How long finished tasks spent in each stage, for the tasks placed by
+    // one scheduler type: waiting for a node after submission (or after
+    // run_at), queued on a node, from first start to finish (time spent
+    // preempted included), and in total. Tasks canceled before they started
+    // are not counted.
+    struct StageLatencies {
+        HistogramSnapshot backlog;
+        HistogramSnapshot nodeQueue;
+        HistogramSnapshot execution;
+        HistogramSnapshot endToEnd;
+    };
+    StageLatencies getStageLatencies(SchedulerType type) const;
+    // "FIFO", "RoundRobin", ... as in getCurrentSchedulerName()
+    static const char* schedulerName(SchedulerType type);
 
 private:
+    // Per-status totals, fed from onStatusChange. Declared first so it
+    // outlives anything that could still report to it.
+    TaskCounters counters;
+    // Sized so that the creation and assignment records of a maximum batch
+    // fit with room to spare, and one /add_tasks call does not push every
+    // change feed reader into a resync
+    static constexpr size_t kChangeLogCapacity = 2 * kMaxBatchSize;
+    ChangeLog changeLog;
+    
+    // One partition of the task table, picked by task id. `ids`,
+    // `statuses` and `tasks` are parallel arrays sorted by id, so lookups
+    // and status scans walk contiguous ids and status bytes instead of
+    // chasing task pointers. `activeIds` holds the ids currently Pending
+    // and Running, which are few next to the completed ones.
+    struct alignas(64) TaskShard {
+        mutable std::mutex mtx;
+        std::vector<int> ids;
+        std::vector<TaskStatus> statuses;
+        std::vector<std::shared_ptr<Task>> tasks;
+        std::set<int> activeIds[2];
+    };
+    
+    std::unique_ptr<TaskShard[]> taskShards;
+    size_t taskShardCount;
+    TaskShard& shardFor(int taskId) const;
+    void insertTask(const std::shared_ptr<Task>& task);
+    void insertTasks(const std::vector<std::shared_ptr<Task>>& tasks);
+    void insertIntoShardLocked(TaskShard& shard, const std::shared_ptr<Task>& task);
+    // Position of the task in the shard's arrays, or -1. Caller holds shard.mtx.
+    long findInShardLocked(const TaskShard& shard, int taskId) const;
+    
+    // Keeps the counters and the status indexes current
+    void onStatusChange(const Task& task, TaskStatus from, TaskStatus to) override;
+    
+    // Guards nodes, nodeIndex, scheduler, readyQueue and the scheduler name/type
+    mutable std::mutex mtx;
+    std::vector<std::shared_ptr<Node>> nodes;
+    std::unique_ptr<Scheduler> scheduler;
+    
     SchedulerType currentSchedulerType;
     std::string currentSchedulerName;
+    // Time spent in scheduler calls, per scheduler name; currentPickLatency
+    // is the current scheduler's entry
+    LabeledHistograms pickLatency;
+    LatencyHistogram* currentPickLatency;
+    
+    struct StageHistograms {
+        LatencyHistogram backlog;
+        LatencyHistogram nodeQueue;
+        LatencyHistogram execution;
+        LatencyHistogram endToEnd;
+    };
+    // Indexed by the SchedulerType in each task's scheduler tag
+    StageHistograms stageHistograms[kSchedulerTypeCount];
+    void recordStageLatencies(const Task& task);
 
-    int nextTaskId;
+    std::atomic<int> nextTaskId;
     int nextNodeId;
     
+    // Id index kept alongside the ordered `nodes` vector. Guarded by mtx.
+    std::unordered_map<int, std::shared_ptr<Node>> nodeIndex;
+    
+    // Holds exactly the nodes in `nodes`; has its own lock
+    NodeLoadIndex loadIndex;
+    
+    // Position of a node in `nodes`, which is kept sorted by id; -1 if absent
+    int findNodePosition(int nodeId) const;
+    
+    // Copy of `nodes` republished whenever it changes; accessed with
+    // std::atomic_load/atomic_store so readers never lock
+    std::shared_ptr<const std::vector<std::shared_ptr<Node>>> nodeSnapshot;
+    void publishNodeSnapshotLocked();
+    
+    // Pending tasks waiting for a node, most urgent first. Guarded by mtx.
+    // Canceled tasks stay in it until dispatch pops and drops them;
+    // readyCanceled counts those, and readyDepth mirrors the size less them
+    // so idle nodes can skip the lock.
+    TaskQueue readyQueue;
+    size_t readyCanceled;
+    std::atomic<size_t> readyDepth;
+    void parkTaskLocked(const std::shared_ptr<Task>& task);
+    void updateReadyDepthLocked();
+    
+    // Places `task` through the scheduler and returns the chosen node id, or
+    // parks it in the ready queue and returns -1. Caller must hold mtx.
+    int placeTaskLocked(const std::shared_ptr<Task>& task);
+    bool dispatchPendingTaskLocked();
+    // Every node is busy and the ready queue is not empty: asks the first
+    // node with a task the policy allows to preempt to free a slot.
+    // Caller must hold mtx.
+    void preemptForReadyQueueLocked();
+    
     // Database manager
     std::shared_ptr<DatabaseManager> dbManager;
+    
+    std::atomic<bool> workStealing;
+    std::atomic<size_t> defaultNodeSlots;
+    std::atomic<bool> shortestJobFirst;
+    // Milliseconds; see setPriorityAging
+    std::atomic<long long> priorityAgingMs;
+    std::atomic<PreemptionPolicy> preemptionPolicy;
+    std::atomic<int> preemptionBudget;
+    
+    // Timers releasing tasks added with a future run_at, keyed by task id so
+    // cancelTask can disarm them. delayedMtx is never held while taking mtx.
+    TimingWheel timers;
+    std::mutex delayedMtx;
+    std::unordered_map<int, TimingWheel::TimerId> delayedTasks;
+    void armDelayedTask(const std::shared_ptr<Task>& task, long long now);
+    void releaseDelayedTask(int taskId);
 };
 
 #endif
\ No newline at end of file
@@ -28,10 +28,11 @@ def request_post(endpoint, json_data):
         print(f"Request error to {endpoint}: {e}")
         return json.dumps({"error": str(e), "type": json_data.get("type", "unknown")})
 
-def request_get(endpoint):
+def request_get(endpoint, params=None):
     try:
         response = requests.get(
             f"{CROW_URL}{endpoint}", 
+            params=params,  # query string to forward, if any
             timeout=5  # 5 second timeout
         )
         response.raise_for_status()  # Raise exception for 4XX/5XX responses
@@ -73,12 +74,22 @@ def get_nodes():
 
 @app.route("/tasks", methods=["GET"])
 def get_tasks():
-    result = request_get("/tasks")
+    # Paging (limit, after_id) and filters (status, all) go to the backend as-is
+    result = request_get("/tasks", request.args)
     try:
         return app.response_class(result, mimetype='application/json')
     except:
         return jsonify([])  # Return empty array if error
 
+# Delta feed polled by the dashboard: since and limit go to the backend as-is
+@app.route("/changes", methods=["GET"])
+def get_changes():
+    result = request_get("/changes", request.args)
+    try:
+        return app.response_class(result, mimetype='application/json')
+    except:
+        return jsonify({"error": "Backend unavailable"})
+
 @app.route("/set_scheduler", methods=["POST"])
 def set_scheduler():
     data = request.get_json()
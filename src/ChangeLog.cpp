@@ -0,0 +1,131 @@
+#include "../include/ChangeLog.h"
+
+ChangeLog::ChangeLog(size_t capacity) : assigned(0), published(0), waiters(0) {
+    size_t rounded = 1;
+    while (rounded < capacity) rounded <<= 1;
+    mask = rounded - 1;
+    slots.reset(new Slot[rounded]);
+}
+
+long long ChangeLog::append(ChangeType type, int taskId, int nodeId, TaskStatus status) {
+    long long version = assigned.fetch_add(1, std::memory_order_relaxed) + 1;
+    Slot& slot = slots[static_cast<size_t>(version) & mask];
+
+    // Readers check the stamp before and after copying the fields, so they
+    // never take a half-written record for a whole one
+    slot.version.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.ids.store(static_cast<uint64_t>(static_cast<uint32_t>(taskId)) << 32 | static_cast<uint32_t>(nodeId),
+                   std::memory_order_relaxed);
+    slot.kind.store(static_cast<uint32_t>(type) | static_cast<uint32_t>(status) << 8, std::memory_order_relaxed);
+    slot.version.store(version, std::memory_order_release);
+
+    // Pairs with the fence in waitForChange(): either the waiter sees this
+    // record, or this sees the waiter and wakes it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(mtx);
+        changed.notify_all();
+    }
+    return version;
+}
+
+bool ChangeLog::readSlot(long long version, ChangeRecord& out) const {
+    const Slot& slot = slots[static_cast<size_t>(version) & mask];
+    if (slot.version.load(std::memory_order_acquire) != version) {
+        return false;
+    }
+    uint64_t ids = slot.ids.load(std::memory_order_relaxed);
+    uint32_t kind = slot.kind.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.version.load(std::memory_order_relaxed) != version) {
+        return false;
+    }
+    out.version = version;
+    out.type = static_cast<ChangeType>(kind & 0xff);
+    out.status = static_cast<TaskStatus>(kind >> 8);
+    out.taskId = static_cast<int>(static_cast<uint32_t>(ids >> 32));
+    out.nodeId = static_cast<int>(static_cast<uint32_t>(ids));
+    return true;
+}
+
+bool ChangeLog::getSince(long long since, size_t maxRecords, std::vector<ChangeRecord>& out) const {
+    long long version = getVersion();
+    if (since == version) {
+        return true;
+    }
+    // A cursor from the future was issued before a restart reset the versions
+    if (since > version || since < 0) {
+        return false;
+    }
+
+    size_t start = out.size();
+    for (long long next = since + 1; next <= version && out.size() - start < maxRecords; ++next) {
+        ChangeRecord record;
+        // Overwritten by a newer record: the reader's cursor fell out of the window
+        if (!readSlot(next, record)) {
+            out.resize(start);
+            return false;
+        }
+        out.push_back(record);
+    }
+    return true;
+}
+
+long long ChangeLog::getVersion() const {
+    long long last = assigned.load(std::memory_order_acquire);
+    long long version = published.load(std::memory_order_acquire);
+    // Older records are evicted whether or not anyone saw them complete
+    long long capacity = static_cast<long long>(mask) + 1;
+    if (version < last - capacity) {
+        version = last - capacity;
+    }
+    while (version < last) {
+        long long stamp = slots[static_cast<size_t>(version + 1) & mask].version.load(std::memory_order_acquire);
+        // A newer stamp means the record was complete and has been overwritten
+        if (stamp < version + 1) {
+            break;
+        }
+        ++version;
+    }
+    // Let the next reader start from here
+    long long seen = published.load(std::memory_order_relaxed);
+    while (seen < version && !published.compare_exchange_weak(seen, version, std::memory_order_release)) {
+    }
+    return version;
+}
+
+long long ChangeLog::waitForChange(long long since, const std::atomic<bool>& keepWaiting) const {
+    long long version = getVersion();
+    if (version != since || !keepWaiting) {
+        return version;
+    }
+    waiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        changed.wait(lock, [&] {
+            version = getVersion();
+            return version != since || !keepWaiting;
+        });
+    }
+    waiters.fetch_sub(1, std::memory_order_relaxed);
+    return version;
+}
+
+void ChangeLog::wakeWaiters() {
+    // Taking the lock orders this after a waiter's last check of keepWaiting
+    std::lock_guard<std::mutex> lock(mtx);
+    changed.notify_all();
+}
+
+const char* ChangeLog::typeName(ChangeType type) {
+    switch (type) {
+        case ChangeType::TaskCreated: return "task_created";
+        case ChangeType::TaskStatusChanged: return "task_status";
+        case ChangeType::TaskAssigned: return "task_assigned";
+        case ChangeType::NodeAdded: return "node_added";
+        case ChangeType::NodeRemoved: return "node_removed";
+    }
+    return "unknown";
+}
@@ -1,18 +1,45 @@
 #include "../include/DatabaseManager.h"
+#include "../include/TaskExecutor.h"
 #include "../include/TaskManager.h"
+#include "../include/loggingservice.h"
 #include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <future>
 #include <thread>
 
 DatabaseManager::DatabaseManager(const std::string& dbPath) 
-    : dbPath(dbPath), db(nullptr) {}
+    : db(nullptr), dbPath(dbPath), stopping(false),
+      syncMode(SyncMode::Normal), maxBatchSize(256), batchWindow(2), allowCommands(false) {}
 
 DatabaseManager::~DatabaseManager() {
+    // Drain outstanding writes before tearing down the connection
+    stopWriter();
+    
+    // Cached statements must be finalized before the connection can close
+    for (auto& entry : statementCache) {
+        sqlite3_finalize(entry.second);
+    }
+    statementCache.clear();
+    
     if (db) {
         sqlite3_close(db);
     }
 }
 
+void DatabaseManager::setSyncMode(SyncMode mode) {
+    syncMode = mode;
+}
+
+void DatabaseManager::setBatchLimits(size_t maxBatch, std::chrono::milliseconds window) {
+    maxBatchSize = maxBatch > 0 ? maxBatch : 1;
+    batchWindow = window;
+}
+
+void DatabaseManager::setAllowCommands(bool allow) {
+    allowCommands = allow;
+}
+
 bool DatabaseManager::initialize() {
     int rc = sqlite3_open(dbPath.c_str(), &db);
     if (rc != SQLITE_OK) {
@@ -31,6 +58,28 @@ bool DatabaseManager::initialize() {
         return false;
     }
     
+    // WAL lets a commit append to the log instead of rewriting the database
+    // file, and with synchronous=NORMAL it only syncs at checkpoints
+    rc = sqlite3_exec(db, "PRAGMA journal_mode = WAL;", nullptr, nullptr, &errMsg);
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL error enabling WAL: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    
+    const char* syncPragma = "PRAGMA synchronous = NORMAL;";
+    switch (syncMode) {
+        case SyncMode::Off: syncPragma = "PRAGMA synchronous = OFF;"; break;
+        case SyncMode::Normal: syncPragma = "PRAGMA synchronous = NORMAL;"; break;
+        case SyncMode::Full: syncPragma = "PRAGMA synchronous = FULL;"; break;
+    }
+    rc = sqlite3_exec(db, syncPragma, nullptr, nullptr, &errMsg);
+    if (rc != SQLITE_OK) {
+        std::cerr << "SQL error setting synchronous mode: " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    
     // Create tables if they don't exist
     const char* createTasksTable = 
         "CREATE TABLE IF NOT EXISTS tasks ("
@@ -80,376 +129,675 @@ bool DatabaseManager::initialize() {
         return false;
     }
     
-    std::cout << "Database initialized successfully." << std::endl;
-    return true;
-}
-
-bool DatabaseManager::saveTask(const std::shared_ptr<Task>& task) {
-    const char* sql = "INSERT OR REPLACE INTO tasks (id, name, duration, status, updated_at) "
-                      "VALUES (?, ?, ?, ?, CURRENT_TIMESTAMP);";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return false;
-    
-    sqlite3_bind_int(stmt, 1, task->getId());
-    sqlite3_bind_text(stmt, 2, task->getName().c_str(), -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 3, task->getDuration());
-    sqlite3_bind_int(stmt, 4, static_cast<int>(task->getStatus()));
-    
-    int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    
-    if (rc != SQLITE_DONE) {
-        logError("saveTask");
+    // Columns added after the original schema; older databases get them here
+    if (!ensureColumn("tasks", "executor", "TEXT DEFAULT 'sleep'") ||
+        !ensureColumn("tasks", "payload", "TEXT DEFAULT ''") ||
+        !ensureColumn("tasks", "run_at", "INTEGER DEFAULT 0") ||
+        !ensureColumn("tasks", "priority", "INTEGER DEFAULT 1") ||
+        !ensureColumn("tasks", "submitted_at", "INTEGER DEFAULT 0") ||
+        !ensureColumn("tasks", "assigned_at", "INTEGER DEFAULT 0") ||
+        !ensureColumn("tasks", "started_at", "INTEGER DEFAULT 0") ||
+        !ensureColumn("tasks", "finished_at", "INTEGER DEFAULT 0") ||
+        !ensureColumn("nodes", "slots", "INTEGER DEFAULT 1")) {
         return false;
     }
     
+    // From here on the writer thread owns the connection
+    stopping = false;
+    writer = std::thread(&DatabaseManager::writerLoop, this);
+    
+    LOG_INFO("Database initialized successfully.");
     return true;
 }
 
-bool DatabaseManager::updateTaskStatus(int taskId, TaskStatus status) {
-    const char* sql = "UPDATE tasks SET status = ?, updated_at = CURRENT_TIMESTAMP WHERE id = ?;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return false;
+void DatabaseManager::writerLoop() {
+    std::vector<Job> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queueMtx);
+            queueCv.wait(lock, [&] { return !jobQueue.empty() || stopping; });
+            
+            if (jobQueue.empty())
+                break; // Stopping and fully drained
+            
+            // Keep collecting until the batch is full, the window closes, or
+            // an urgent job (read/flush) asks for the batch to be committed
+            auto deadline = std::chrono::steady_clock::now() + batchWindow;
+            while (batch.size() < maxBatchSize) {
+                if (jobQueue.empty()) {
+                    if (stopping || !queueCv.wait_until(lock, deadline, [&] { return !jobQueue.empty() || stopping; }))
+                        break;
+                    if (jobQueue.empty())
+                        break;
+                }
+                batch.push_back(std::move(jobQueue.front()));
+                jobQueue.pop_front();
+                if (batch.back().urgent)
+                    break;
+            }
+        }
+        commitBatch(batch);
+        batch.clear();
+    }
+}
+
+void DatabaseManager::commitBatch(std::vector<Job>& batch) {
+    auto start = std::chrono::steady_clock::now();
     
-    sqlite3_bind_int(stmt, 1, static_cast<int>(status));
-    sqlite3_bind_int(stmt, 2, taskId);
+    bool inTransaction = db && sqlite3_exec(db, "BEGIN;", nullptr, nullptr, nullptr) == SQLITE_OK;
+    for (auto& job : batch) {
+        job.apply();
+    }
+    if (inTransaction && sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        logError("commitBatch");
+        sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+    }
     
-    int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    auto committed = std::chrono::steady_clock::now();
+    double commitMs = std::chrono::duration<double, std::milli>(committed - start).count();
+    commitTimes.record(committed - start);
+    for (auto& job : batch) {
+        // Urgent jobs are reads and flushes, not writes
+        if (!job.urgent) {
+            writeLatencies.record(committed - job.queuedAt);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(statsMtx);
+        batchStats.commits++;
+        batchStats.jobs += batch.size();
+        batchStats.lastBatchSize = batch.size();
+        batchStats.maxBatchSize = std::max(batchStats.maxBatchSize, batch.size());
+        batchStats.lastCommitMs = commitMs;
+        batchStats.maxCommitMs = std::max(batchStats.maxCommitMs, commitMs);
+        batchStats.totalCommitMs += commitMs;
+    }
     
-    if (rc != SQLITE_DONE) {
-        logError("updateTaskStatus");
-        return false;
+    for (auto& job : batch) {
+        if (job.onCommit) job.onCommit();
+    }
+}
+
+void DatabaseManager::stopWriter() {
+    {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        stopping = true;
+    }
+    queueCv.notify_all();
+    if (writer.joinable()) writer.join();
+}
+
+bool DatabaseManager::enqueue(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(queueMtx);
+        if (writer.joinable() && !stopping) {
+            job.queuedAt = std::chrono::steady_clock::now();
+            jobQueue.push_back(std::move(job));
+            queueCv.notify_one();
+            return true;
+        }
     }
     
+    // No writer thread (not initialized yet, or shutting down): apply directly
+    job.apply();
+    if (job.onCommit) job.onCommit();
     return true;
 }
 
-std::vector<std::shared_ptr<Task>> DatabaseManager::loadAllTasks() {
-    std::vector<std::shared_ptr<Task>> tasks;
-    const char* sql = "SELECT id, name, duration, status FROM tasks ORDER BY id;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return tasks;
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        int id = sqlite3_column_int(stmt, 0);
-        std::string name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        int duration = sqlite3_column_int(stmt, 2);
-        TaskStatus status = static_cast<TaskStatus>(sqlite3_column_int(stmt, 3));
-        
-        auto task = std::make_shared<Task>(id, name, duration);
-        task->setStatus(status);
-        tasks.push_back(task);
+bool DatabaseManager::enqueue(std::function<void()> apply) {
+    Job job;
+    job.apply = std::move(apply);
+    return enqueue(std::move(job));
+}
+
+template <typename T>
+T DatabaseManager::runQuery(std::function<T()> query) {
+    std::packaged_task<T()> task(std::move(query));
+    std::future<T> result = task.get_future();
+    
+    // The caller blocks on the future, so the job can safely refer to the local task
+    Job job;
+    job.apply = [&task] { task(); };
+    job.urgent = true;
+    enqueue(std::move(job));
+    return result.get();
+}
+
+void DatabaseManager::flush() {
+    std::promise<void> committed;
+    std::future<void> done = committed.get_future();
+    
+    Job job;
+    job.apply = [] {};
+    job.onCommit = [&committed] { committed.set_value(); };
+    job.urgent = true;
+    enqueue(std::move(job));
+    done.wait();
+}
+
+BatchStats DatabaseManager::getBatchStats() const {
+    std::lock_guard<std::mutex> lock(statsMtx);
+    return batchStats;
+}
+
+const LatencyHistogram& DatabaseManager::getCommitTimes() const {
+    return commitTimes;
+}
+
+const LatencyHistogram& DatabaseManager::getWriteLatencies() const {
+    return writeLatencies;
+}
+
+bool DatabaseManager::saveTask(const std::shared_ptr<Task>& task) {
+    // Snapshot the fields now; the writer may run after the task has moved on
+    int id = task->getId();
+    std::string name = task->getName();
+    int duration = task->getDuration();
+    int status = static_cast<int>(task->getStatus());
+    auto executor = task->getExecutor();
+    std::string kind = executor ? executor->kind() : "sleep";
+    std::string payload = executor ? executor->payload() : "";
+    long long runAt = task->getRunAt();
+    int priority = static_cast<int>(task->getPriority());
+    long long submittedAt = task->getTimeline().submitted;
+    
+    return enqueue([this, id, name, duration, status, kind, payload, runAt, priority, submittedAt] {
+        const char* sql = "INSERT OR REPLACE INTO tasks (id, name, duration, status, executor, payload, run_at, priority, "
+                          "submitted_at, updated_at) "
+                          "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, CURRENT_TIMESTAMP);";
+        
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return;
+        
+        sqlite3_bind_int(stmt, 1, id);
+        sqlite3_bind_text(stmt, 2, name.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 3, duration);
+        sqlite3_bind_int(stmt, 4, status);
+        sqlite3_bind_text(stmt, 5, kind.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 6, payload.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int64(stmt, 7, runAt);
+        sqlite3_bind_int(stmt, 8, priority);
+        sqlite3_bind_int64(stmt, 9, submittedAt);
+        
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        
+        if (rc != SQLITE_DONE) {
+            logError("saveTask");
+        }
+    });
+}
+
+bool DatabaseManager::saveTasks(const std::vector<std::shared_ptr<Task>>& tasks, const std::vector<int>& nodeIds) {
+    struct Row {
+        int id;
+        std::string name;
+        int duration;
+        int status;
+        std::string kind;
+        std::string payload;
+        long long runAt;
+        int priority;
+        long long submittedAt;
+        int nodeId;
+    };
+    
+    // Snapshot the fields now; the writer may run after the tasks have moved on
+    auto rows = std::make_shared<std::vector<Row>>();
+    rows->reserve(tasks.size());
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        auto executor = tasks[i]->getExecutor();
+        rows->push_back(Row{tasks[i]->getId(), tasks[i]->getName(), tasks[i]->getDuration(),
+                            static_cast<int>(tasks[i]->getStatus()),
+                            executor ? executor->kind() : "sleep",
+                            executor ? executor->payload() : "",
+                            tasks[i]->getRunAt(),
+                            static_cast<int>(tasks[i]->getPriority()),
+                            tasks[i]->getTimeline().submitted,
+                            i < nodeIds.size() ? nodeIds[i] : -1});
     }
     
-    sqlite3_finalize(stmt);
-    return tasks;
+    return enqueue([this, rows] {
+        sqlite3_stmt* insertTask = prepareStatement(
+            "INSERT OR REPLACE INTO tasks (id, name, duration, status, executor, payload, run_at, priority, "
+            "submitted_at, updated_at) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, CURRENT_TIMESTAMP);");
+        sqlite3_stmt* insertAssignment = prepareStatement(
+            "INSERT OR REPLACE INTO task_node (task_id, node_id) VALUES (?, ?);");
+        if (!insertTask || !insertAssignment) return;
+        
+        for (const auto& row : *rows) {
+            sqlite3_bind_int(insertTask, 1, row.id);
+            sqlite3_bind_text(insertTask, 2, row.name.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(insertTask, 3, row.duration);
+            sqlite3_bind_int(insertTask, 4, row.status);
+            sqlite3_bind_text(insertTask, 5, row.kind.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(insertTask, 6, row.payload.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(insertTask, 7, row.runAt);
+            sqlite3_bind_int(insertTask, 8, row.priority);
+            sqlite3_bind_int64(insertTask, 9, row.submittedAt);
+            int rc = sqlite3_step(insertTask);
+            sqlite3_reset(insertTask);
+            if (rc != SQLITE_DONE) {
+                logError("saveTasks");
+                continue;
+            }
+            
+            if (row.nodeId != -1) {
+                sqlite3_bind_int(insertAssignment, 1, row.id);
+                sqlite3_bind_int(insertAssignment, 2, row.nodeId);
+                rc = sqlite3_step(insertAssignment);
+                sqlite3_reset(insertAssignment);
+                if (rc != SQLITE_DONE) {
+                    logError("saveTasks");
+                }
+            }
+        }
+    });
+}
+
+bool DatabaseManager::updateTaskStatus(int taskId, TaskStatus status) {
+    return enqueue([this, taskId, status] {
+        const char* sql = "UPDATE tasks SET status = ?, updated_at = CURRENT_TIMESTAMP WHERE id = ?;";
+        
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return;
+        
+        sqlite3_bind_int(stmt, 1, static_cast<int>(status));
+        sqlite3_bind_int(stmt, 2, taskId);
+        
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        
+        if (rc != SQLITE_DONE) {
+            logError("updateTaskStatus");
+        }
+    });
+}
+
+bool DatabaseManager::updateTaskStatus(int taskId, TaskStatus status, const TaskTimeline& timeline) {
+    return enqueue([this, taskId, status, timeline] {
+        const char* sql = "UPDATE tasks SET status = ?, assigned_at = ?, started_at = ?, finished_at = ?, "
+                          "updated_at = CURRENT_TIMESTAMP WHERE id = ?;";
+        
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return;
+        
+        sqlite3_bind_int(stmt, 1, static_cast<int>(status));
+        sqlite3_bind_int64(stmt, 2, timeline.assigned);
+        sqlite3_bind_int64(stmt, 3, timeline.started);
+        sqlite3_bind_int64(stmt, 4, timeline.finished);
+        sqlite3_bind_int(stmt, 5, taskId);
+        
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        
+        if (rc != SQLITE_DONE) {
+            logError("updateTaskStatus");
+        }
+    });
+}
+
+std::vector<std::shared_ptr<Task>> DatabaseManager::loadAllTasks() {
+    return runQuery<std::vector<std::shared_ptr<Task>>>([this] {
+        std::vector<std::shared_ptr<Task>> tasks;
+        const char* sql = "SELECT id, name, duration, status, executor, payload, run_at, priority, "
+                          "submitted_at, assigned_at, started_at, finished_at FROM tasks ORDER BY id;";
+        
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return tasks;
+        
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int id = sqlite3_column_int(stmt, 0);
+            std::string name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            int duration = sqlite3_column_int(stmt, 2);
+            TaskStatus status = static_cast<TaskStatus>(sqlite3_column_int(stmt, 3));
+            
+            auto task = makeTask(id, name, duration);
+            task->setStatus(status);
+            task->setRunAt(sqlite3_column_int64(stmt, 6));
+            task->setPriority(static_cast<TaskPriority>(sqlite3_column_int(stmt, 7)));
+            task->setTimeline(readTimeline(stmt, 8));
+            restoreExecutor(*task, stmt, 4);
+            tasks.push_back(task);
+        }
+        
+        sqlite3_reset(stmt);
+        return tasks;
+    });
 }
 
 std::shared_ptr<Task> DatabaseManager::loadTask(int taskId) {
-    const char* sql = "SELECT id, name, duration, status FROM tasks WHERE id = ?;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return nullptr;
-    
-    sqlite3_bind_int(stmt, 1, taskId);
-    
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        int id = sqlite3_column_int(stmt, 0);
-        std::string name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-        int duration = sqlite3_column_int(stmt, 2);
-        TaskStatus status = static_cast<TaskStatus>(sqlite3_column_int(stmt, 3));
+    return runQuery<std::shared_ptr<Task>>([this, taskId]() -> std::shared_ptr<Task> {
+        const char* sql = "SELECT id, name, duration, status, executor, payload, run_at, priority, "
+                          "submitted_at, assigned_at, started_at, finished_at FROM tasks WHERE id = ?;";
         
-        auto task = std::make_shared<Task>(id, name, duration);
-        task->setStatus(status);
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return nullptr;
         
-        sqlite3_finalize(stmt);
+        sqlite3_bind_int(stmt, 1, taskId);
+        
+        std::shared_ptr<Task> task;
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            int id = sqlite3_column_int(stmt, 0);
+            std::string name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            int duration = sqlite3_column_int(stmt, 2);
+            TaskStatus status = static_cast<TaskStatus>(sqlite3_column_int(stmt, 3));
+            
+            task = makeTask(id, name, duration);
+            task->setStatus(status);
+            task->setRunAt(sqlite3_column_int64(stmt, 6));
+            task->setPriority(static_cast<TaskPriority>(sqlite3_column_int(stmt, 7)));
+            task->setTimeline(readTimeline(stmt, 8));
+            restoreExecutor(*task, stmt, 4);
+        }
+        
+        sqlite3_reset(stmt);
         return task;
-    }
-    
-    sqlite3_finalize(stmt);
-    return nullptr;
+    });
 }
 
 bool DatabaseManager::deleteTask(int taskId) {
-    const char* sql = "DELETE FROM tasks WHERE id = ?;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return false;
-    
-    sqlite3_bind_int(stmt, 1, taskId);
-    
-    int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    
-    if (rc != SQLITE_DONE) {
-        logError("deleteTask");
-        return false;
-    }
-    
-    return true;
+    return enqueue([this, taskId] {
+        const char* sql = "DELETE FROM tasks WHERE id = ?;";
+        
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return;
+        
+        sqlite3_bind_int(stmt, 1, taskId);
+        
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        
+        if (rc != SQLITE_DONE) {
+            logError("deleteTask");
+        }
+    });
 }
 
 bool DatabaseManager::saveNode(const std::shared_ptr<Node>& node) {
-    const char* sql = "INSERT OR REPLACE INTO nodes (id, task_count) VALUES (?, ?);";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return false;
-    
-    sqlite3_bind_int(stmt, 1, node->getId());
-    sqlite3_bind_int(stmt, 2, node->getTaskCount());
+    int id = node->getId();
+    int taskCount = node->getTaskCount();
+    int slots = static_cast<int>(node->getSlotCount());
     
-    int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    
-    if (rc != SQLITE_DONE) {
-        logError("saveNode");
-        return false;
-    }
-    
-    return true;
+    return enqueue([this, id, taskCount, slots] {
+        const char* sql = "INSERT OR REPLACE INTO nodes (id, task_count, slots) VALUES (?, ?, ?);";
+        
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return;
+        
+        sqlite3_bind_int(stmt, 1, id);
+        sqlite3_bind_int(stmt, 2, taskCount);
+        sqlite3_bind_int(stmt, 3, slots);
+        
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        
+        if (rc != SQLITE_DONE) {
+            logError("saveNode");
+        }
+    });
 }
 
 bool DatabaseManager::updateNodeTaskCount(int nodeId, int taskCount) {
-    const char* sql = "UPDATE nodes SET task_count = ? WHERE id = ?;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return false;
-    
-    sqlite3_bind_int(stmt, 1, taskCount);
-    sqlite3_bind_int(stmt, 2, nodeId);
-    
-    int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    
-    if (rc != SQLITE_DONE) {
-        logError("updateNodeTaskCount");
-        return false;
-    }
-    
-    return true;
+    return enqueue([this, nodeId, taskCount] {
+        const char* sql = "UPDATE nodes SET task_count = ? WHERE id = ?;";
+        
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return;
+        
+        sqlite3_bind_int(stmt, 1, taskCount);
+        sqlite3_bind_int(stmt, 2, nodeId);
+        
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        
+        if (rc != SQLITE_DONE) {
+            logError("updateNodeTaskCount");
+        }
+    });
 }
 
 std::vector<std::shared_ptr<Node>> DatabaseManager::loadAllNodes(TaskManager* manager) {
-    std::vector<std::shared_ptr<Node>> nodes;
-    const char* sql = "SELECT id FROM nodes ORDER BY id;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return nodes;
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        int id = sqlite3_column_int(stmt, 0);
+    return runQuery<std::vector<std::shared_ptr<Node>>>([this, manager] {
+        std::vector<std::shared_ptr<Node>> nodes;
+        const char* sql = "SELECT id, slots FROM nodes ORDER BY id;";
         
-        // Create a node with a reference to the task manager
-        auto node = std::make_shared<Node>(id, manager);
-        nodes.push_back(node);
-    }
-    
-    sqlite3_finalize(stmt);
-    return nodes;
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return nodes;
+        
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int id = sqlite3_column_int(stmt, 0);
+            int slots = sqlite3_column_int(stmt, 1);
+            
+            // Create a node with a reference to the task manager
+            auto node = std::make_shared<Node>(id, manager, slots > 0 ? slots : 1);
+            nodes.push_back(node);
+        }
+        
+        sqlite3_reset(stmt);
+        return nodes;
+    });
 }
 
 bool DatabaseManager::deleteNode(int nodeId) {
-    const char* sql = "DELETE FROM nodes WHERE id = ?;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return false;
-    
-    sqlite3_bind_int(stmt, 1, nodeId);
-    
-    int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    
-    if (rc != SQLITE_DONE) {
-        logError("deleteNode");
-        return false;
-    }
-    
-    return true;
+    return enqueue([this, nodeId] {
+        const char* sql = "DELETE FROM nodes WHERE id = ?;";
+        
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return;
+        
+        sqlite3_bind_int(stmt, 1, nodeId);
+        
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        
+        if (rc != SQLITE_DONE) {
+            logError("deleteNode");
+        }
+    });
 }
 
 bool DatabaseManager::assignTaskToNode(int taskId, int nodeId) {
-    const char* sql = "INSERT OR REPLACE INTO task_node (task_id, node_id) VALUES (?, ?);";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return false;
-    
-    sqlite3_bind_int(stmt, 1, taskId);
-    sqlite3_bind_int(stmt, 2, nodeId);
-    
-    int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    
-    if (rc != SQLITE_DONE) {
-        logError("assignTaskToNode");
-        return false;
-    }
-    
-    return true;
+    return enqueue([this, taskId, nodeId] {
+        const char* sql = "INSERT OR REPLACE INTO task_node (task_id, node_id) VALUES (?, ?);";
+        
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return;
+        
+        sqlite3_bind_int(stmt, 1, taskId);
+        sqlite3_bind_int(stmt, 2, nodeId);
+        
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        
+        if (rc != SQLITE_DONE) {
+            logError("assignTaskToNode");
+        }
+    });
 }
 
 bool DatabaseManager::removeTaskFromNode(int taskId, int nodeId) {
-    const char* sql = "DELETE FROM task_node WHERE task_id = ? AND node_id = ?;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return false;
-    
-    sqlite3_bind_int(stmt, 1, taskId);
-    sqlite3_bind_int(stmt, 2, nodeId);
-    
-    int rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-    
-    if (rc != SQLITE_DONE) {
-        logError("removeTaskFromNode");
-        return false;
-    }
-    
-    return true;
+    return enqueue([this, taskId, nodeId] {
+        const char* sql = "DELETE FROM task_node WHERE task_id = ? AND node_id = ?;";
+        
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return;
+        
+        sqlite3_bind_int(stmt, 1, taskId);
+        sqlite3_bind_int(stmt, 2, nodeId);
+        
+        int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        
+        if (rc != SQLITE_DONE) {
+            logError("removeTaskFromNode");
+        }
+    });
 }
 
 std::vector<int> DatabaseManager::getNodeTaskIds(int nodeId) {
-    std::vector<int> taskIds;
-    const char* sql = "SELECT task_id FROM task_node WHERE node_id = ?;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return taskIds;
-    
-    sqlite3_bind_int(stmt, 1, nodeId);
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        int taskId = sqlite3_column_int(stmt, 0);
-        taskIds.push_back(taskId);
-    }
-    
-    sqlite3_finalize(stmt);
-    return taskIds;
+    return runQuery<std::vector<int>>([this, nodeId] {
+        std::vector<int> taskIds;
+        const char* sql = "SELECT task_id FROM task_node WHERE node_id = ?;";
+        
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return taskIds;
+        
+        sqlite3_bind_int(stmt, 1, nodeId);
+        
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            int taskId = sqlite3_column_int(stmt, 0);
+            taskIds.push_back(taskId);
+        }
+        
+        sqlite3_reset(stmt);
+        return taskIds;
+    });
 }
 
 int DatabaseManager::getTaskCount() {
-    const char* sql = "SELECT COUNT(*) FROM tasks;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return 0;
-    
-    int count = 0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        count = sqlite3_column_int(stmt, 0);
-    }
-    
-    sqlite3_finalize(stmt);
-    return count;
+    return scalarQuery("SELECT COUNT(*) FROM tasks;");
 }
 
 int DatabaseManager::getNodeCount() {
-    const char* sql = "SELECT COUNT(*) FROM nodes;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return 0;
-    
-    int count = 0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        count = sqlite3_column_int(stmt, 0);
-    }
-    
-    sqlite3_finalize(stmt);
-    return count;
+    return scalarQuery("SELECT COUNT(*) FROM nodes;");
 }
 
 int DatabaseManager::getPendingTaskCount() {
-    const char* sql = "SELECT COUNT(*) FROM tasks WHERE status = 0;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return 0;
-    
-    int count = 0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        count = sqlite3_column_int(stmt, 0);
-    }
-    
-    sqlite3_finalize(stmt);
-    return count;
+    return scalarQuery("SELECT COUNT(*) FROM tasks WHERE status = 0;");
 }
 
 int DatabaseManager::getRunningTaskCount() {
-    const char* sql = "SELECT COUNT(*) FROM tasks WHERE status = 1;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return 0;
-    
-    int count = 0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        count = sqlite3_column_int(stmt, 0);
-    }
-    
-    sqlite3_finalize(stmt);
-    return count;
+    return scalarQuery("SELECT COUNT(*) FROM tasks WHERE status = 1;");
 }
 
 int DatabaseManager::getCompletedTaskCount() {
-    const char* sql = "SELECT COUNT(*) FROM tasks WHERE status = 2;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return 0;
-    
-    int count = 0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        count = sqlite3_column_int(stmt, 0);
-    }
-    
-    sqlite3_finalize(stmt);
-    return count;
+    return scalarQuery("SELECT COUNT(*) FROM tasks WHERE status = 2;");
 }
 
 int DatabaseManager::getLastInsertId() {
-    return static_cast<int>(sqlite3_last_insert_rowid(db));
+    return runQuery<int>([this] {
+        return static_cast<int>(sqlite3_last_insert_rowid(db));
+    });
 }
 
 int DatabaseManager::getMaxTaskId() {
-    const char* sql = "SELECT MAX(id) FROM tasks;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return 0;
-    
-    int maxId = 0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        maxId = sqlite3_column_int(stmt, 0);
-    }
-    
-    sqlite3_finalize(stmt);
-    return maxId;
+    return scalarQuery("SELECT MAX(id) FROM tasks;");
 }
 
 int DatabaseManager::getMaxNodeId() {
-    const char* sql = "SELECT MAX(id) FROM nodes;";
-    
-    sqlite3_stmt* stmt = prepareStatement(sql);
-    if (!stmt) return 0;
-    
-    int maxId = 0;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        maxId = sqlite3_column_int(stmt, 0);
-    }
-    
-    sqlite3_finalize(stmt);
-    return maxId;
+    return scalarQuery("SELECT MAX(id) FROM nodes;");
+}
+
+int DatabaseManager::scalarQuery(const std::string& sql) {
+    return runQuery<int>([this, sql] {
+        sqlite3_stmt* stmt = prepareStatement(sql);
+        if (!stmt) return 0;
+        
+        int value = 0;
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            value = sqlite3_column_int(stmt, 0);
+        }
+        
+        sqlite3_reset(stmt);
+        return value;
+    });
 }
 
 sqlite3_stmt* DatabaseManager::prepareStatement(const std::string& sql) {
+    // Reuse the compiled statement if this query has been seen before
+    auto it = statementCache.find(sql);
+    if (it != statementCache.end()) {
+        sqlite3_reset(it->second);
+        sqlite3_clear_bindings(it->second);
+        return it->second;
+    }
+    
     sqlite3_stmt* stmt;
-    int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr);
+    int rc = sqlite3_prepare_v3(db, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr);
     
     if (rc != SQLITE_OK) {
         std::cerr << "Failed to prepare statement: " << sqlite3_errmsg(db) << std::endl;
         return nullptr;
     }
     
+    statementCache.emplace(sql, stmt);
     return stmt;
 }
 
+bool DatabaseManager::ensureColumn(const std::string& table, const std::string& column, const std::string& definition) {
+    std::string pragma = "PRAGMA table_info(" + table + ");";
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, pragma.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        logError("ensureColumn");
+        return false;
+    }
+    bool exists = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        if (name && column == name) {
+            exists = true;
+            break;
+        }
+    }
+    sqlite3_finalize(stmt);
+    if (exists) {
+        return true;
+    }
+    
+    std::string alter = "ALTER TABLE " + table + " ADD COLUMN " + column + " " + definition + ";";
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, alter.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::cerr << "SQL error adding column " << table << "." << column << ": " << errMsg << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    LOG_INFO("Added column ", table, ".", column);
+    return true;
+}
+
+void DatabaseManager::restoreExecutor(Task& task, sqlite3_stmt* stmt, int column) {
+    const char* kindText = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+    const char* payloadText = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column + 1));
+    std::string kind = kindText ? kindText : "sleep";
+    std::string payload = payloadText ? payloadText : "";
+    
+    std::shared_ptr<TaskExecutor> executor;
+    if (kind == "command" && !allowCommands) {
+        LOG_WARNING("Task ", task.getId(), ": command tasks are disabled ",
+                    "(TASKMASTER_ALLOW_COMMANDS), marking it failed");
+    } else {
+        executor = makeExecutor(kind, payload);
+        if (!executor) {
+            LOG_WARNING("Task ", task.getId(), ": cannot restore '", kind,
+                        "' executor, marking it failed");
+        }
+    }
+    if (executor) {
+        task.setExecutor(executor);
+        return;
+    }
+    
+    // Running it as anything else would not be the task that was submitted.
+    // One that already finished keeps its outcome.
+    if (task.getStatus() != TaskStatus::Completed) {
+        task.markFailed();
+        task.setStatus(TaskStatus::Completed);
+        // Queued behind this read on the writer thread
+        updateTaskStatus(task.getId(), TaskStatus::Completed, task.getTimeline());
+    }
+}
+
+TaskTimeline DatabaseManager::readTimeline(sqlite3_stmt* stmt, int column) {
+    TaskTimeline timeline;
+    timeline.submitted = sqlite3_column_int64(stmt, column);
+    timeline.assigned = sqlite3_column_int64(stmt, column + 1);
+    timeline.started = sqlite3_column_int64(stmt, column + 2);
+    timeline.finished = sqlite3_column_int64(stmt, column + 3);
+    return timeline;
+}
+
 void DatabaseManager::logError(const std::string& operation) {
     std::cerr << "SQLite error during " << operation << ": " << sqlite3_errmsg(db) << std::endl;
 }
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include "../include/EventBroadcaster.h"
+#include "../include/TaskManager.h"
+#include "../include/ChangeLog.h"
+#include <cstdio>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// Upper bound on records read from the change log per pass
+const size_t kMaxRecordsPerPass = 4096;
+
+std::string jsonEscape(const std::string& value) {
+    std::string out;
+    out.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+std::string versionFrame(const char* type, long long version) {
+    return std::string("{\"type\":\"") + type + "\",\"version\":" + std::to_string(version) + "}";
+}
+
+}  // namespace
+
+EventBroadcaster::EventBroadcaster(TaskManager& manager, std::chrono::milliseconds window, size_t maxPending)
+    : manager(manager), window(window), maxPending(maxPending),
+      nextClientId(1), version(0), running(false) {}
+
+EventBroadcaster::~EventBroadcaster() {
+    stop();
+}
+
+void EventBroadcaster::start() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (running) {
+        return;
+    }
+    version = manager.getChangeLog().getVersion();
+    running = true;
+    worker = std::thread(&EventBroadcaster::run, this);
+}
+
+void EventBroadcaster::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    cv.notify_all();
+    manager.getChangeLog().wakeWaiters();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+int EventBroadcaster::subscribe(Sink sink) {
+    std::lock_guard<std::mutex> lock(mtx);
+    int clientId = nextClientId++;
+    Client& client = clients[clientId];
+    client.sink = std::move(sink);
+    // The client should load /tasks and /nodes after this; events from here on follow
+    client.sink(versionFrame("hello", version));
+    return clientId;
+}
+
+void EventBroadcaster::unsubscribe(int clientId) {
+    std::lock_guard<std::mutex> lock(mtx);
+    clients.erase(clientId);
+}
+
+void EventBroadcaster::acknowledge(int clientId) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = clients.find(clientId);
+    if (it == clients.end()) {
+        return;
+    }
+    it->second.awaitingAck = false;
+    // Whatever piled up while the client was busy goes out right away
+    flushLocked(it->second);
+}
+
+size_t EventBroadcaster::getClientCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return clients.size();
+}
+
+void EventBroadcaster::run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (running) {
+        // Nothing to do until the log moves: subscribe() and acknowledge()
+        // send their frames themselves
+        long long seen = version;
+        lock.unlock();
+        manager.getChangeLog().waitForChange(seen, running);
+        lock.lock();
+        if (clients.empty()) {
+            // Nobody listening: just keep up with the log
+            version = manager.getChangeLog().getVersion();
+            continue;
+        }
+        // The window is what coalesces bursts of changes into one frame
+        cv.wait_for(lock, window, [this] { return !running; });
+        if (!running) {
+            break;
+        }
+        collectLocked();
+        for (auto& entry : clients) {
+            flushLocked(entry.second);
+        }
+    }
+}
+
+void EventBroadcaster::collectLocked() {
+    std::vector<ChangeRecord> records;
+    if (!manager.getChangeLog().getSince(version, kMaxRecordsPerPass, records)) {
+        // We fell out of the log window ourselves; everyone has to resync
+        version = manager.getChangeLog().getVersion();
+        for (auto& entry : clients) {
+            entry.second.tasks.clear();
+            entry.second.nodes.clear();
+            entry.second.overflowed = true;
+        }
+        return;
+    }
+    if (records.empty()) {
+        return;
+    }
+    version = records.back().version;
+
+    for (auto& entry : clients) {
+        Client& client = entry.second;
+        if (client.overflowed) {
+            continue; // Resync pending, nothing else matters
+        }
+        for (const auto& record : records) {
+            if (record.taskId != -1) {
+                int& nodeId = client.tasks.emplace(record.taskId, -1).first->second;
+                if (record.type == ChangeType::TaskAssigned) {
+                    nodeId = record.nodeId;
+                }
+            } else if (record.nodeId != -1) {
+                client.nodes[record.nodeId] = record.type == ChangeType::NodeAdded;
+            }
+        }
+        if (client.tasks.size() + client.nodes.size() > maxPending) {
+            // Too far behind to be worth catching up event by event
+            client.tasks.clear();
+            client.nodes.clear();
+            client.overflowed = true;
+        }
+    }
+}
+
+void EventBroadcaster::flushLocked(Client& client) {
+    if (client.awaitingAck) {
+        return;
+    }
+    if (client.overflowed) {
+        client.overflowed = false;
+        client.awaitingAck = true;
+        client.sink(versionFrame("resync", version));
+        return;
+    }
+    if (client.tasks.empty() && client.nodes.empty()) {
+        return;
+    }
+    client.awaitingAck = true;
+    client.sink(buildEventsFrame(client));
+    client.tasks.clear();
+    client.nodes.clear();
+}
+
+std::string EventBroadcaster::buildEventsFrame(const Client& client) const {
+    std::ostringstream os;
+    os << "{\"type\":\"events\",\"version\":" << version << ",\"tasks\":[";
+    bool first = true;
+    for (const auto& entry : client.tasks) {
+        // Send the task as it is now, which folds every change in the window
+        auto task = manager.getTask(entry.first);
+        if (!task) {
+            continue;
+        }
+        os << (first ? "" : ",")
+           << "{\"id\":" << task->getId()
+           << ",\"name\":\"" << jsonEscape(task->getName()) << "\""
+           << ",\"duration\":" << task->getDuration()
+           << ",\"status\":" << static_cast<int>(task->getStatus());
+        if (entry.second != -1) {
+            os << ",\"node_id\":" << entry.second;
+        }
+        os << "}";
+        first = false;
+    }
+    os << "],\"nodes\":[";
+    first = true;
+    for (const auto& entry : client.nodes) {
+        os << (first ? "" : ",")
+           << "{\"id\":" << entry.first
+           << ",\"event\":\"" << (entry.second ? "added" : "removed") << "\"}";
+        first = false;
+    }
+    os << "]}";
+    return os.str();
+}
@@ -0,0 +1,63 @@
+#include "../include/LeastWorkScheduler.h"
+#include "../include/Node.h"
+#include "../include/Task.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+int LeastWorkScheduler::pickNode(const std::vector<std::shared_ptr<Node>>& nodes) {
+    int leastIndex = -1;
+    long long leastWork = std::numeric_limits<long long>::max();
+    
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i]->isBusy()) continue;
+        long long work = nodes[i]->getOutstandingWork();
+        if (work < leastWork) {
+            leastWork = work;
+            leastIndex = static_cast<int>(i);
+        }
+    }
+    return leastIndex;
+}
+
+std::vector<int> LeastWorkScheduler::pickNodes(const std::vector<std::shared_ptr<Node>>& nodes, size_t count) {
+    return pickByWork(nodes, std::vector<long long>(count, 1000));
+}
+
+std::vector<int> LeastWorkScheduler::pickNodesForTasks(const std::vector<std::shared_ptr<Node>>& nodes,
+                                                       const std::vector<std::shared_ptr<Task>>& tasks) {
+    std::vector<long long> taskWork;
+    taskWork.reserve(tasks.size());
+    for (const auto& task : tasks) {
+        // In milliseconds, like Node::getOutstandingWork. Zero-duration tasks
+        // still count for something, so a batch of them spreads out.
+        taskWork.push_back(std::max(task->getDuration(), 1) * 1000LL);
+    }
+    return pickByWork(nodes, taskWork);
+}
+
+std::vector<int> LeastWorkScheduler::pickByWork(const std::vector<std::shared_ptr<Node>>& nodes,
+                                                const std::vector<long long>& taskWork) {
+    // Min-heap of (outstanding work, node index) over the nodes that can take work
+    using Work = std::pair<long long, int>;
+    std::priority_queue<Work, std::vector<Work>, std::greater<Work>> work;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (!nodes[i]->isBusy()) {
+            work.emplace(nodes[i]->getOutstandingWork(), static_cast<int>(i));
+        }
+    }
+    
+    std::vector<int> picks(taskWork.size(), -1);
+    if (work.empty()) {
+        return picks;
+    }
+    for (size_t i = 0; i < taskWork.size(); ++i) {
+        Work least = work.top();
+        work.pop();
+        picks[i] = least.second;
+        work.emplace(least.first + taskWork[i], least.second);
+    }
+    return picks;
+}
@@ -1,13 +1,49 @@
 // LoadBalancedScheduler.cpp
 #include "../include/LoadBalancedScheduler.h"
 #include "../include/Node.h"
+#include "../include/NodeLoadIndex.h"
 #include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace {
+
+// Position of the node with `nodeId` in the id-sorted node list, or -1
+int positionOf(const std::vector<std::shared_ptr<Node>>& nodes, int nodeId) {
+    auto it = std::lower_bound(nodes.begin(), nodes.end(), nodeId,
+        [](const std::shared_ptr<Node>& node, int id) { return node->getId() < id; });
+    if (it == nodes.end() || (*it)->getId() != nodeId) {
+        return -1;
+    }
+    return static_cast<int>(it - nodes.begin());
+}
+
+}  // namespace
+
+void LoadBalancedScheduler::setLoadIndex(NodeLoadIndex* index) {
+    loadIndex = index;
+}
 
 int LoadBalancedScheduler::pickNode(const std::vector<std::shared_ptr<Node>>& nodes) {
     if (nodes.empty()) {
         return -1;
     }
+    if (!loadIndex) {
+        return scanForLeastLoaded(nodes);
+    }
     
+    int nodeId = loadIndex->leastLoaded();
+    if (nodeId == -1) {
+        return -1;
+    }
+    int position = positionOf(nodes, nodeId);
+    // The index only knows TaskManager's nodes; fall back for any other list
+    return position != -1 ? position : scanForLeastLoaded(nodes);
+}
+
+int LoadBalancedScheduler::scanForLeastLoaded(const std::vector<std::shared_ptr<Node>>& nodes) const {
     int minTasksIndex = -1;
     int minTasks = std::numeric_limits<int>::max();
     
@@ -23,4 +59,43 @@ int LoadBalancedScheduler::pickNode(const std::vector<std::shared_ptr<Node>>& no
     }
     
     return minTasksIndex;
+}
+
+std::vector<int> LoadBalancedScheduler::pickNodes(const std::vector<std::shared_ptr<Node>>& nodes, size_t count) {
+    if (loadIndex && !nodes.empty()) {
+        std::vector<int> picks = loadIndex->reserve(count);
+        bool known = true;
+        for (auto& pick : picks) {
+            if (pick == -1) continue;
+            pick = positionOf(nodes, pick);
+            if (pick == -1) {
+                known = false;
+                break;
+            }
+        }
+        if (known) {
+            return picks;
+        }
+    }
+    
+    // Min-heap of (task count, node index) over the nodes that can take work
+    using Load = std::pair<int, int>;
+    std::priority_queue<Load, std::vector<Load>, std::greater<Load>> loads;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (!nodes[i]->isBusy()) {
+            loads.emplace(nodes[i]->getTaskCount(), static_cast<int>(i));
+        }
+    }
+    
+    std::vector<int> picks(count, -1);
+    if (loads.empty()) {
+        return picks;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        Load least = loads.top();
+        loads.pop();
+        picks[i] = least.second;
+        loads.emplace(least.first + 1, least.second);
+    }
+    return picks;
 }
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "../include/Metrics.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+
+namespace {
+
+// Histogram bucket boundaries reported to Prometheus: 2^10 ns to 2^36 ns
+const int kFirstReportedExponent = 10;
+const int kLastReportedExponent = 36;
+
+void appendNumber(std::string& out, double value) {
+    if (std::isinf(value)) {
+        out += value > 0 ? "+Inf" : "-Inf";
+        return;
+    }
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+}  // namespace
+
+uint64_t HistogramSnapshot::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+    q = std::min(std::max(q, 0.0), 1.0);
+    // Rank of the value we want, 1-based
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * count)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return i + 1 < counts.size() ? LatencyHistogram::bucketLowerBound(i + 1) - 1
+                                         : LatencyHistogram::bucketLowerBound(i);
+        }
+    }
+    return LatencyHistogram::bucketLowerBound(counts.size() - 1);
+}
+
+uint64_t HistogramSnapshot::countBelow(uint64_t nanos) const {
+    size_t end = LatencyHistogram::bucketIndex(nanos);
+    uint64_t total = 0;
+    for (size_t i = 0; i < end && i < counts.size(); ++i) {
+        total += counts[i];
+    }
+    return total;
+}
+
+LatencyHistogram::LatencyHistogram() : sumNanos(0) {
+    for (auto& bucket : counts) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t nanos) {
+    // The first 2 * kSubBuckets values each have a bucket of their own
+    if (nanos < 2 * kSubBuckets) {
+        return static_cast<size_t>(nanos);
+    }
+    int exponent = 63 - __builtin_clzll(nanos);
+    if (exponent >= kMaxExponent) {
+        return kBucketCount - 1;
+    }
+    size_t sub = static_cast<size_t>(nanos >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return static_cast<size_t>(exponent - kSubBucketBits + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(size_t index) {
+    if (index < 2 * kSubBuckets) {
+        return index;
+    }
+    int exponent = static_cast<int>(index / kSubBuckets) + kSubBucketBits - 1;
+    uint64_t sub = index % kSubBuckets;
+    return (kSubBuckets + sub) << (exponent - kSubBucketBits);
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+    counts[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+    sumNanos.fetch_add(nanos, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::record(std::chrono::steady_clock::duration elapsed) {
+    auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    record(static_cast<uint64_t>(nanos > 0 ? nanos : 0));
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    uint64_t total = 0;
+    for (const auto& bucket : counts) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const {
+    HistogramSnapshot result;
+    result.counts.resize(kBucketCount);
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        result.counts[i] = counts[i].load(std::memory_order_relaxed);
+        result.count += result.counts[i];
+    }
+    result.sumNanos = sumNanos.load(std::memory_order_relaxed);
+    return result;
+}
+
+LabeledHistograms::LabeledHistograms(std::string overflowLabel) : overflow(std::move(overflowLabel)) {
+    for (auto& slot : entries) {
+        slot.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+LabeledHistograms::~LabeledHistograms() {
+    for (auto& slot : entries) {
+        delete slot.load(std::memory_order_relaxed);
+    }
+}
+
+LatencyHistogram* LabeledHistograms::find(std::string_view labels) const {
+    for (const auto& slot : entries) {
+        Entry* entry = slot.load(std::memory_order_acquire);
+        if (!entry) break;
+        if (entry->labels == labels) {
+            return &entry->histogram;
+        }
+    }
+    return nullptr;
+}
+
+LatencyHistogram& LabeledHistograms::get(std::string_view labels) {
+    if (LatencyHistogram* histogram = find(labels)) {
+        return *histogram;
+    }
+    std::lock_guard<std::mutex> lock(addMtx);
+    // Another thread may have added it since the lock-free lookup
+    for (auto& slot : entries) {
+        Entry* entry = slot.load(std::memory_order_relaxed);
+        if (!entry) {
+            entry = new Entry(std::string(labels));
+            slot.store(entry, std::memory_order_release);
+            return entry->histogram;
+        }
+        if (entry->labels == labels) {
+            return entry->histogram;
+        }
+    }
+    return overflow.histogram;
+}
+
+LatencyHistogram& LabeledHistograms::overflowHistogram() {
+    return overflow.histogram;
+}
+
+void MetricsWriter::family(std::string_view name, std::string_view type, std::string_view help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void MetricsWriter::sample(std::string_view name, std::string_view labels, double value) {
+    out += name;
+    if (!labels.empty()) {
+        out += '{';
+        out += labels;
+        out += '}';
+    }
+    out += ' ';
+    appendNumber(out, value);
+    out += '\n';
+}
+
+void MetricsWriter::histogram(std::string_view name, std::string_view labels, const HistogramSnapshot& snapshot) {
+    std::string bucketName = std::string(name) + "_bucket";
+    std::string prefix = labels.empty() ? std::string() : std::string(labels) + ",";
+    for (int exponent = kFirstReportedExponent; exponent <= kLastReportedExponent; ++exponent) {
+        uint64_t bound = uint64_t(1) << exponent;
+        std::string le;
+        appendNumber(le, bound / 1e9);
+        sample(bucketName, prefix + label("le", le), static_cast<double>(snapshot.countBelow(bound)));
+    }
+    sample(bucketName, prefix + "le=\"+Inf\"", static_cast<double>(snapshot.count));
+    sample(std::string(name) + "_sum", labels, snapshot.sumNanos / 1e9);
+    sample(std::string(name) + "_count", labels, static_cast<double>(snapshot.count));
+}
+
+std::string MetricsWriter::label(std::string_view key, std::string_view value) {
+    std::string result(key);
+    result += "=\"";
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            result += '\\';
+            result += c;
+        } else if (c == '\n') {
+            result += "\\n";
+        } else {
+            result += c;
+        }
+    }
+    result += '"';
+    return result;
+}
+
+const std::string& MetricsWriter::str() const {
+    return out;
+}
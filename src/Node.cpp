@@ -2,46 +2,180 @@
 #include "../include/TaskManager.h"  // This is needed for Node.cpp to access TaskManager methods
 #include "../include/Scheduler.h"
 #include "../include/DatabaseManager.h" 
+#include "../include/TaskExecutor.h"
+#include "../include/loggingservice.h"
 #include <chrono>
-#include <iostream>
 #include <algorithm>
 
-Node::Node(int id) : id(id), busy(false), running(false), taskCount(0) {}
+// How long an idle node waits for pushed work before trying to steal
+static const std::chrono::milliseconds kStealInterval(10);
+// Peers an idle slot looks at per steal attempt
+static const size_t kStealVictims = 2;
 
-Node::Node(int id, TaskManager* manager) 
-    : id(id), busy(false), running(false), taskCount(0), taskManager(manager) {}
+Node::Node(int id) : Node(id, nullptr) {}
+
+Node::Node(int id, TaskManager* manager, size_t slots) 
+    : id(id), slotCount(slots > 0 ? slots : 1), activeSlots(0), running(false),
+      taskManager(manager), taskCount(0), load(0), outstandingWork(0), runningTasks(slotCount),
+      slotClocks(new SlotClock[slotCount]), preemptionPolicy(PreemptionPolicy::Off), preemptionBudget(0) {}
 
 
 void Node::start() {
     running = true;
-    worker = std::thread(&Node::processTasks, this);
+    for (size_t slot = 0; slot < slotCount; ++slot) {
+        workers.emplace_back(&Node::processTasks, this, slot);
+    }
 }
 
 void Node::stop() {
-    running = false;
+    {
+        // Idle slots may be waiting without a timeout
+        std::lock_guard<std::mutex> lock(mtx);
+        running = false;
+    }
     cv.notify_all();
-    if (worker.joinable()) worker.join();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
 }
 
 void Node::addTask(std::shared_ptr<Task> task) {
     {
         std::lock_guard<std::mutex> lock(mtx);
-        taskQueue.push(task);
+        enqueueLocked(task);
         taskIDs.push_back(task->getId());  // Track task ID
         taskCount++;
+        reportLoadLocked();
+        preemptForLocked(taskQueue.topPriority());
         
         // Update node task count in database if task manager is available
         if (taskManager && taskManager->getDbManager()) {
             taskManager->getDbManager()->updateNodeTaskCount(id, taskCount);
         }
         
-        std::cout << "Task ID: " << task->getId() << " added to Node " << id << std::endl;
+        // Every single-task placement path (scheduler, manual, stealing) ends up here
+        if (taskManager) {
+            taskManager->getChangeLog().append(ChangeType::TaskAssigned, task->getId(), id, task->getStatus());
+        }
+        
+        LOG_DEBUG("Task ID: ", task->getId(), " added to Node ", id);
     }
     cv.notify_one();
 }
 
+void Node::addTasks(const std::vector<std::shared_ptr<Task>>& tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto& task : tasks) {
+            enqueueLocked(task);
+            taskIDs.push_back(task->getId());
+            if (taskManager) {
+                taskManager->getChangeLog().append(ChangeType::TaskAssigned, task->getId(), id, task->getStatus());
+            }
+        }
+        taskCount += static_cast<int>(tasks.size());
+        reportLoadLocked();
+        preemptForLocked(taskQueue.topPriority());
+        
+        // Update node task count in database if task manager is available
+        if (taskManager && taskManager->getDbManager()) {
+            taskManager->getDbManager()->updateNodeTaskCount(id, taskCount);
+        }
+        
+        LOG_DEBUG(tasks.size(), " tasks added to Node ", id);
+    }
+    cv.notify_all();
+}
+
+void Node::enqueueLocked(const std::shared_ptr<Task>& task) {
+    task->markAssigned();
+    outstandingWork += task->getDuration();
+    taskQueue.push(task);
+}
+
+void Node::setShortestJobFirst(bool enabled) {
+    std::lock_guard<std::mutex> lock(mtx);
+    taskQueue.setShortestJobFirst(enabled);
+}
+
+void Node::setPriorityAging(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(mtx);
+    taskQueue.setAgingInterval(interval);
+}
+
+void Node::setPreemption(PreemptionPolicy policy, int budget) {
+    std::lock_guard<std::mutex> lock(mtx);
+    preemptionPolicy = policy;
+    preemptionBudget = budget;
+}
+
+bool Node::preemptFor(TaskPriority priority) {
+    std::lock_guard<std::mutex> lock(mtx);
+    return preemptForLocked(priority);
+}
+
+bool Node::preemptForLocked(TaskPriority priority) {
+    if (preemptionPolicy == PreemptionPolicy::Off || !isBusy() ||
+        (preemptionPolicy == PreemptionPolicy::Critical && priority != TaskPriority::Critical)) {
+        return false;
+    }
+    std::shared_ptr<Task> victim;
+    for (const auto& task : runningTasks) {
+        if (!task) continue;
+        auto executor = task->getExecutor();
+        bool preemptible = executor ? executor->isPreemptible() : true;  // the default sleep is
+        // One slot at a time; the next waiting task asks again once it is free
+        if (preemptible && task->isYieldRequested()) {
+            return false;
+        }
+        if (!preemptible || task->getPriority() >= priority || task->getPreemptionCount() >= preemptionBudget) {
+            continue;
+        }
+        if (!victim || task->getPriority() < victim->getPriority()) {
+            victim = task;
+        }
+    }
+    if (!victim) {
+        return false;
+    }
+    victim->requestYield();
+    LOG_DEBUG("Node ", id, " asked Task ID: ", victim->getId(), " to yield");
+    return true;
+}
+
+long long Node::getOutstandingWork() const {
+    long long work = outstandingWork.load() * 1000;
+    long long now = Task::clockMicros();
+    for (size_t slot = 0; slot < slotCount; ++slot) {
+        int duration = slotClocks[slot].duration.load(std::memory_order_acquire);
+        if (duration <= 0) {
+            continue;
+        }
+        // An overrunning task counts as done, not as negative work
+        long long ranMs = (now - slotClocks[slot].startedAt.load(std::memory_order_relaxed)) / 1000;
+        work -= std::min(ranMs, duration * 1000LL);
+    }
+    // The slot may have been read just after its task left outstandingWork
+    return std::max(work, 0LL);
+}
+
+void Node::reportLoadLocked() {
+    load = taskCount;
+    if (taskManager) {
+        taskManager->getLoadIndex().update(id, taskCount, isBusy());
+    }
+}
+
 bool Node::isBusy() const {
-    return busy.load();
+    return activeSlots.load() >= static_cast<int>(slotCount);
+}
+
+size_t Node::getSlotCount() const {
+    return slotCount;
 }
 
 int Node::getId() const {
@@ -53,6 +187,23 @@ int Node::getTaskCount() const {
     return taskCount;
 }
 
+int Node::getLoad() const {
+    return load.load();
+}
+
+size_t Node::getQueueDepth() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return taskQueue.size();
+}
+
+int Node::getActiveSlots() const {
+    return activeSlots.load();
+}
+
+const LatencyHistogram& Node::getExecutionTimes() const {
+    return executionTimes;
+}
+
 std::vector<int> Node::getTaskIDs() const {
     std::lock_guard<std::mutex> lock(mtx);
     return taskIDs;
@@ -60,92 +211,215 @@ std::vector<int> Node::getTaskIDs() const {
 
 std::vector<std::shared_ptr<Task>> Node::getTaskQueueSnapshot() {
     std::lock_guard<std::mutex> lock(mtx);
-    std::queue<std::shared_ptr<Task>> copy = taskQueue;
-    std::vector<std::shared_ptr<Task>> tasks;
-    while (!copy.empty()) {
-        tasks.push_back(copy.front());
-        copy.pop();
+    return taskQueue.snapshot();
+}
+
+std::vector<std::shared_ptr<Task>> Node::drainQueue() {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::vector<std::shared_ptr<Task>> tasks = taskQueue.takeAll();
+    for (auto& task : tasks) {
+        outstandingWork -= task->getDuration();
+        taskIDs.erase(std::remove(taskIDs.begin(), taskIDs.end(), task->getId()), taskIDs.end());
+        if (taskManager && taskManager->getDbManager()) {
+            taskManager->getDbManager()->removeTaskFromNode(task->getId(), id);
+        }
     }
+    taskCount -= static_cast<int>(tasks.size());
+    reportLoadLocked();
     return tasks;
 }
 
-void Node::processTasks() {
+void Node::wake() {
+    std::lock_guard<std::mutex> lock(mtx);
+    cv.notify_all();
+}
+
+std::shared_ptr<Task> Node::stealTask() {
+    std::lock_guard<std::mutex> lock(mtx);
+    // A free slot is about to take this queue itself; a stopped node is being drained
+    if (!running || !isBusy() || taskQueue.empty()) {
+        return nullptr;
+    }
+    
+    auto task = taskQueue.popLeastUrgent();
+    taskIDs.erase(std::remove(taskIDs.begin(), taskIDs.end(), task->getId()), taskIDs.end());
+    taskCount--;
+    outstandingWork -= task->getDuration();
+    reportLoadLocked();
+    
+    if (taskManager && taskManager->getDbManager()) {
+        taskManager->getDbManager()->updateNodeTaskCount(id, taskCount);
+        taskManager->getDbManager()->removeTaskFromNode(task->getId(), id);
+    }
+    return task;
+}
+
+bool Node::stealWork(std::minstd_rand& rng) {
+    // Peers come from a lock-free snapshot, so stealing never takes TaskManager::mtx
+    auto peers = taskManager->getNodeSnapshot();
+    if (!peers || peers->size() < 2) {
+        return false;
+    }
+    
+    // A few random peers, skipped without their lock unless every slot is
+    // busy and something is queued behind them
+    for (size_t attempt = 0; attempt < kStealVictims; ++attempt) {
+        const auto& victim = (*peers)[rng() % peers->size()];
+        if (victim.get() == this || !victim->isBusy() ||
+            victim->getLoad() <= static_cast<int>(victim->getSlotCount())) {
+            continue;
+        }
+        
+        auto task = victim->stealTask();
+        if (task) {
+            addTask(task);
+            if (taskManager->getDbManager()) {
+                taskManager->getDbManager()->assignTaskToNode(task->getId(), id);
+            }
+            LOG_DEBUG("Node ", id, " stole Task ID: ", task->getId(), " from Node ", victim->getId());
+            return true;
+        }
+    }
+    return false;
+}
+
+void Node::completeTask(size_t slot, const std::shared_ptr<Task>& task, bool ok) {
+    if (!ok) {
+        LOG_WARNING("Task ID: ", task->getId(), " failed on Node ", id);
+    }
+    task->setStatus(TaskStatus::Completed);
+    
+    // Update task status in database if task manager is available
+    if (taskManager && taskManager->getDbManager()) {
+        taskManager->getDbManager()->updateTaskStatus(task->getId(), TaskStatus::Completed,
+                                                      task->getTimeline());
+    }
+    
+    LOG_DEBUG("Task ID: ", task->getId(), " Completed on Node ", id);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    activeSlots--;
+    runningTasks[slot].reset();
+    slotClocks[slot].duration.store(0, std::memory_order_release);
+    outstandingWork -= task->getDuration();
+    if (taskCount > 0) {
+        taskCount--;
+        
+        // Update node task count in database if task manager is available
+        if (taskManager && taskManager->getDbManager()) {
+            taskManager->getDbManager()->updateNodeTaskCount(id, taskCount);
+            taskManager->getDbManager()->removeTaskFromNode(task->getId(), id);
+        }
+        
+        // Remove from taskIDs
+        taskIDs.erase(std::remove(taskIDs.begin(), taskIDs.end(), task->getId()), taskIDs.end());
+        LOG_DEBUG("Node ", id, " task count decremented. Current count: ", taskCount);
+    }
+    reportLoadLocked();
+}
+
+void Node::requeueYieldedTask(size_t slot, const std::shared_ptr<Task>& task) {
+    if (taskManager && taskManager->getDbManager()) {
+        taskManager->getDbManager()->updateTaskStatus(task->getId(), TaskStatus::Pending);
+    }
+    LOG_DEBUG("Task ID: ", task->getId(), " preempted on Node ", id, " (checkpoint ",
+              task->getCheckpoint(), ")");
+
+    // Its count, id and work stay with this node; only the slot is freed
+    std::lock_guard<std::mutex> lock(mtx);
+    activeSlots--;
+    runningTasks[slot].reset();
+    slotClocks[slot].duration.store(0, std::memory_order_release);
+    taskQueue.push(task);
+    reportLoadLocked();
+}
+
+void Node::processTasks(size_t slot) {
+    // Victim selection for stealing, one generator per slot
+    std::minstd_rand rng(static_cast<unsigned>(id * 64 + slot));
     while (running) {
         std::shared_ptr<Task> task;
         {
             std::unique_lock<std::mutex> lock(mtx);
-            cv.wait(lock, [&] { return !taskQueue.empty() || !running; });
+            auto hasWork = [&] { return !taskQueue.empty() || !running; };
+            if (taskManager && taskManager->isWorkStealingEnabled()) {
+                // Idle nodes wake up periodically to look for work to steal
+                cv.wait_for(lock, kStealInterval, hasWork);
+            } else {
+                // Nothing to steal: sleep until work is pushed, the node
+                // stops, or stealing is turned on
+                cv.wait(lock, [&] {
+                    return hasWork() || (taskManager && taskManager->isWorkStealingEnabled());
+                });
+            }
 
             if (!running && taskQueue.empty())
                 break;
 
-            if (!taskQueue.empty()) {
-                task = taskQueue.front();
-                taskQueue.pop();
-                busy = true;
+            // Tasks canceled while they were queued are dropped, not run
+            bool loadChanged = false;
+            std::shared_ptr<Task> candidate;
+            while ((candidate = taskQueue.pop())) {
+                if (candidate->getStatus() == TaskStatus::Pending) {
+                    task = candidate;
+                    break;
+                }
+                loadChanged = true;
+                taskIDs.erase(std::remove(taskIDs.begin(), taskIDs.end(), candidate->getId()), taskIDs.end());
+                taskCount--;
+                outstandingWork -= candidate->getDuration();
+                if (taskManager && taskManager->getDbManager()) {
+                    taskManager->getDbManager()->updateNodeTaskCount(id, taskCount);
+                    taskManager->getDbManager()->removeTaskFromNode(candidate->getId(), id);
+                }
+            }
+
+            if (task) {
+                activeSlots++;
+                runningTasks[slot] = task;
+                slotClocks[slot].startedAt.store(Task::clockMicros(), std::memory_order_relaxed);
+                slotClocks[slot].duration.store(task->getDuration(), std::memory_order_release);
+                loadChanged = true;
                 task->setStatus(TaskStatus::Running);
                 
                 // Update task status in database if task manager is available
                 if (taskManager && taskManager->getDbManager()) {
-                    taskManager->getDbManager()->updateTaskStatus(task->getId(), TaskStatus::Running);
+                    taskManager->getDbManager()->updateTaskStatus(task->getId(), TaskStatus::Running,
+                                                                  task->getTimeline());
                 }
                 
-                std::cout << "Processing Task ID: " << task->getId() << " on Node " << id << std::endl;
+                LOG_DEBUG("Processing Task ID: ", task->getId(), " on Node ", id);
+            }
+            if (loadChanged) {
+                reportLoadLocked();
+            }
+            // Whatever is still waiting may outrank another running task
+            if (task && !taskQueue.empty()) {
+                preemptForLocked(taskQueue.topPriority());
             }
         }
 
         if (task) {
-            std::this_thread::sleep_for(std::chrono::seconds(task->getDuration()));
-            task->setStatus(TaskStatus::Completed);
-            
-            // Update task status in database if task manager is available
-            if (taskManager && taskManager->getDbManager()) {
-                taskManager->getDbManager()->updateTaskStatus(task->getId(), TaskStatus::Completed);
-            }
-            
-            std::cout << "Task ID: " << task->getId() << " Completed on Node " << id << std::endl;
-
-            {
-                std::lock_guard<std::mutex> lock(mtx);
-                if (taskCount > 0) {
-                    taskCount--;
-                    
-                    // Update node task count in database if task manager is available
-                    if (taskManager && taskManager->getDbManager()) {
-                        taskManager->getDbManager()->updateNodeTaskCount(id, taskCount);
-                        taskManager->getDbManager()->removeTaskFromNode(task->getId(), id);
-                    }
-                    
-                    // Remove from taskIDs
-                    taskIDs.erase(std::remove(taskIDs.begin(), taskIDs.end(), task->getId()), taskIDs.end());
-                    std::cout << "Node " << id << " task count decremented. Current count: " << taskCount << std::endl;
-                }
+            bool ok = executionTimes.time([&] { return task->execute(); });
+            // A task canceled while it ran is not requeued, even if it yielded:
+            // the switch back to Pending fails once cancelTask has completed it
+            if (task->hasYielded() && task->compareAndSetStatus(TaskStatus::Running, TaskStatus::Pending)) {
+                requeueYieldedTask(slot, task);
+            } else {
+                completeTask(slot, task, ok);
             }
         }
 
-        busy = false;
-
-        // Check for pending tasks in the TaskManager and assign if possible
-        if (running && taskManager) {
-            std::lock_guard<std::mutex> managerLock(taskManager->mtx);
-            for (auto& pendingTask : taskManager->tasks) {
-                if (pendingTask->getStatus() == TaskStatus::Pending) {
-                    int nodeIndex = taskManager->scheduler->pickNode(taskManager->nodes);
-                    if (nodeIndex >= 0 && nodeIndex < static_cast<int>(taskManager->nodes.size()) && 
-                        taskManager->nodes[nodeIndex]->getId() == id) {
-                        addTask(pendingTask);
-                        
-                        // Record task assignment in database
-                        if (taskManager->getDbManager()) {
-                            taskManager->getDbManager()->assignTaskToNode(pendingTask->getId(), id);
-                        }
-                        
-                        std::cout << "Reassigned pending task '" << pendingTask->getName()
-                                  << "' to Node " << id << std::endl;
-                        break; // Assign only one task at a time
-                    }
-                }
-            }
+        if (!running || !taskManager) {
+            continue;
+        }
+        
+        if (task) {
+            // Pull the next waiting task from the TaskManager's ready queue, if any
+            taskManager->dispatchPendingTask();
+        } else if (taskManager->isWorkStealingEnabled()) {
+            // Nothing was pushed to us: take work from the tail of a busy peer
+            stealWork(rng);
         }
     }
 }
\ No newline at end of file
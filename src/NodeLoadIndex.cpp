@@ -0,0 +1,110 @@
+#include "../include/NodeLoadIndex.h"
+#include <utility>
+
+void NodeLoadIndex::add(int nodeId) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (positions.count(nodeId)) {
+        return;
+    }
+    heap.push_back(Entry{nodeId, 0, false});
+    positions[nodeId] = heap.size() - 1;
+    siftUp(heap.size() - 1);
+}
+
+void NodeLoadIndex::remove(int nodeId) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = positions.find(nodeId);
+    if (it == positions.end()) {
+        return;
+    }
+    size_t position = it->second;
+    size_t last = heap.size() - 1;
+    if (position != last) {
+        swapEntries(position, last);
+    }
+    heap.pop_back();
+    positions.erase(nodeId);
+    if (position < heap.size()) {
+        siftUp(position);
+        siftDown(position);
+    }
+}
+
+void NodeLoadIndex::update(int nodeId, int load, bool busy) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = positions.find(nodeId);
+    if (it == positions.end()) {
+        return;
+    }
+    size_t position = it->second;
+    heap[position].load = load;
+    heap[position].busy = busy;
+    siftUp(position);
+    siftDown(positions[nodeId]);
+}
+
+int NodeLoadIndex::leastLoaded() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (heap.empty() || heap.front().busy) {
+        return -1;
+    }
+    return heap.front().nodeId;
+}
+
+std::vector<int> NodeLoadIndex::reserve(size_t count) {
+    std::vector<int> picks(count, -1);
+    std::lock_guard<std::mutex> lock(mtx);
+    if (heap.empty() || heap.front().busy) {
+        return picks;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        picks[i] = heap.front().nodeId;
+        heap.front().load++;
+        siftDown(0);
+    }
+    return picks;
+}
+
+size_t NodeLoadIndex::size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return heap.size();
+}
+
+bool NodeLoadIndex::before(const Entry& a, const Entry& b) {
+    if (a.busy != b.busy) return !a.busy;
+    if (a.load != b.load) return a.load < b.load;
+    // Same order as a scan over the id-sorted node list
+    return a.nodeId < b.nodeId;
+}
+
+void NodeLoadIndex::swapEntries(size_t a, size_t b) {
+    std::swap(heap[a], heap[b]);
+    positions[heap[a].nodeId] = a;
+    positions[heap[b].nodeId] = b;
+}
+
+void NodeLoadIndex::siftUp(size_t position) {
+    while (position > 0) {
+        size_t parent = (position - 1) / 2;
+        if (!before(heap[position], heap[parent])) {
+            break;
+        }
+        swapEntries(position, parent);
+        position = parent;
+    }
+}
+
+void NodeLoadIndex::siftDown(size_t position) {
+    while (true) {
+        size_t smallest = position;
+        size_t left = 2 * position + 1;
+        size_t right = left + 1;
+        if (left < heap.size() && before(heap[left], heap[smallest])) smallest = left;
+        if (right < heap.size() && before(heap[right], heap[smallest])) smallest = right;
+        if (smallest == position) {
+            break;
+        }
+        swapEntries(position, smallest);
+        position = smallest;
+    }
+}
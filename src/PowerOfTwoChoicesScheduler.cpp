@@ -0,0 +1,63 @@
+#include "../include/PowerOfTwoChoicesScheduler.h"
+#include "../include/Node.h"
+#include <limits>
+
+// Sampling rounds before falling back to a scan for a node that isn't busy
+static const int kSampleRounds = 4;
+
+PowerOfTwoChoicesScheduler::PowerOfTwoChoicesScheduler(size_t choices)
+    : choices(choices > 0 ? choices : 1), rng(std::random_device{}()) {}
+
+int PowerOfTwoChoicesScheduler::pickNode(const std::vector<std::shared_ptr<Node>>& nodes) {
+    return pick(nodes, {});
+}
+
+std::vector<int> PowerOfTwoChoicesScheduler::pickNodes(const std::vector<std::shared_ptr<Node>>& nodes, size_t count) {
+    std::vector<int> picks(count, -1);
+    std::vector<int> extra(nodes.size(), 0);
+    for (size_t i = 0; i < count; ++i) {
+        picks[i] = pick(nodes, extra);
+        if (picks[i] == -1) {
+            break;  // Every node is busy; the rest wait too
+        }
+        extra[picks[i]]++;
+    }
+    return picks;
+}
+
+int PowerOfTwoChoicesScheduler::pick(const std::vector<std::shared_ptr<Node>>& nodes, const std::vector<int>& extra) {
+    if (nodes.empty()) {
+        return -1;
+    }
+    auto loadOf = [&](size_t i) { return nodes[i]->getLoad() + (extra.empty() ? 0 : extra[i]); };
+    
+    for (int round = 0; round < kSampleRounds; ++round) {
+        int best = -1;
+        int bestLoad = std::numeric_limits<int>::max();
+        for (size_t c = 0; c < choices; ++c) {
+            size_t i = rng() % nodes.size();
+            if (nodes[i]->isBusy()) continue;
+            int load = loadOf(i);
+            if (load < bestLoad) {
+                bestLoad = load;
+                best = static_cast<int>(i);
+            }
+        }
+        if (best != -1) {
+            return best;
+        }
+    }
+    
+    // Every sample was busy: most of the cluster is, so look at all of it
+    int best = -1;
+    int bestLoad = std::numeric_limits<int>::max();
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i]->isBusy()) continue;
+        int load = loadOf(i);
+        if (load < bestLoad) {
+            bestLoad = load;
+            best = static_cast<int>(i);
+        }
+    }
+    return best;
+}
@@ -0,0 +1,154 @@
+#include "../include/SlabPool.h"
+#include <map>
+#include <utility>
+
+namespace {
+
+// Distinct thread-cached pools a thread can cache blocks for; further pools
+// use the shared free list
+const size_t kCachedPoolsPerThread = 8;
+
+// Set once this thread's cache is gone, for blocks freed later in its exit
+thread_local bool threadCacheDestroyed = false;
+
+}  // namespace
+
+struct SlabPool::ThreadCache {
+    CacheEntry entries[kCachedPoolsPerThread];
+
+    ~ThreadCache() {
+        threadCacheDestroyed = true;
+        // Blocks a finished thread was holding go back to their pools
+        for (auto& entry : entries) {
+            if (!entry.head) continue;
+            FreeBlock* last = entry.head;
+            while (last->next) last = last->next;
+            std::lock_guard<std::mutex> lock(entry.pool->mtx);
+            entry.pool->releaseLocked(entry.head, last, entry.count);
+        }
+    }
+};
+
+SlabPool::SlabPool(size_t blockSize, size_t blockAlign, size_t blocksPerSlab, bool threadCache)
+    : blockAlign(blockAlign < alignof(FreeBlock) ? alignof(FreeBlock) : blockAlign),
+      blocksPerSlab(blocksPerSlab > 0 ? blocksPerSlab : 1),
+      freeList(nullptr), bumpNext(nullptr), bumpEnd(nullptr), used(0), threadCache(threadCache) {
+    // Every block must hold a free-list link and keep the next block aligned
+    size_t size = blockSize < sizeof(FreeBlock) ? sizeof(FreeBlock) : blockSize;
+    this->blockSize = (size + this->blockAlign - 1) / this->blockAlign * this->blockAlign;
+}
+
+SlabPool::~SlabPool() {
+    for (void* slab : slabs) {
+        ::operator delete(slab, std::align_val_t(blockAlign));
+    }
+}
+
+SlabPool::CacheEntry* SlabPool::cacheEntry() {
+    if (threadCacheDestroyed) {
+        return nullptr;
+    }
+    thread_local ThreadCache cache;
+    for (auto& entry : cache.entries) {
+        if (entry.pool == this) {
+            return &entry;
+        }
+        if (!entry.pool) {
+            entry.pool = this;
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void* SlabPool::allocate() {
+    CacheEntry* entry = threadCache ? cacheEntry() : nullptr;
+    if (!entry) {
+        std::lock_guard<std::mutex> lock(mtx);
+        return takeLocked();
+    }
+    if (!entry->head) {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (size_t i = 0; i < kCacheBatch; ++i) {
+            auto* block = static_cast<FreeBlock*>(takeLocked());
+            block->next = entry->head;
+            entry->head = block;
+        }
+        entry->count = kCacheBatch;
+    }
+    FreeBlock* block = entry->head;
+    entry->head = block->next;
+    entry->count--;
+    return block;
+}
+
+void* SlabPool::takeLocked() {
+    used++;
+    if (freeList) {
+        FreeBlock* block = freeList;
+        freeList = block->next;
+        return block;
+    }
+    if (bumpNext == bumpEnd) {
+        char* slab = static_cast<char*>(::operator new(blockSize * blocksPerSlab, std::align_val_t(blockAlign)));
+        slabs.push_back(slab);
+        bumpNext = slab;
+        bumpEnd = slab + blockSize * blocksPerSlab;
+    }
+    void* block = bumpNext;
+    bumpNext += blockSize;
+    return block;
+}
+
+void SlabPool::deallocate(void* block) {
+    auto* freed = static_cast<FreeBlock*>(block);
+    CacheEntry* entry = threadCache ? cacheEntry() : nullptr;
+    if (!entry) {
+        std::lock_guard<std::mutex> lock(mtx);
+        releaseLocked(freed, freed, 1);
+        return;
+    }
+    freed->next = entry->head;
+    entry->head = freed;
+    if (++entry->count < 2 * kCacheBatch) {
+        return;
+    }
+    // Keep one batch; the other goes back, so blocks freed on this thread
+    // can be allocated on others
+    FreeBlock* first = entry->head;
+    FreeBlock* last = first;
+    for (size_t i = 1; i < kCacheBatch; ++i) {
+        last = last->next;
+    }
+    entry->head = last->next;
+    entry->count -= kCacheBatch;
+    std::lock_guard<std::mutex> lock(mtx);
+    releaseLocked(first, last, kCacheBatch);
+}
+
+void SlabPool::releaseLocked(FreeBlock* first, FreeBlock* last, size_t count) {
+    last->next = freeList;
+    freeList = first;
+    used -= count;
+}
+
+size_t SlabPool::size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return used;
+}
+
+size_t SlabPool::reservedBytes() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return slabs.size() * blockSize * blocksPerSlab;
+}
+
+SlabPool& SlabPool::forSize(size_t blockSize, size_t blockAlign) {
+    static std::mutex registryMtx;
+    static auto* registry = new std::map<std::pair<size_t, size_t>, SlabPool*>();
+    std::lock_guard<std::mutex> lock(registryMtx);
+    auto& pool = (*registry)[{blockSize, blockAlign}];
+    if (!pool) {
+        pool = new SlabPool(blockSize, blockAlign, 4096, true);
+    }
+    return *pool;
+}
@@ -0,0 +1,43 @@
+#include "../include/TaskCounters.h"
+#include <algorithm>
+#include <thread>
+
+TaskCounters::TaskCounters(size_t slotCount)
+    : slotCount(slotCount ? slotCount : std::max(1u, std::thread::hardware_concurrency())) {
+    slots.reset(new Slot[this->slotCount]);
+}
+
+TaskCounters::Slot& TaskCounters::localSlot() {
+    // Threads are spread over the slots in the order they first touch any counter
+    static std::atomic<size_t> nextThread(0);
+    thread_local size_t threadIndex = nextThread.fetch_add(1, std::memory_order_relaxed);
+    return slots[threadIndex % slotCount];
+}
+
+void TaskCounters::onTaskAdded(TaskStatus status) {
+    Slot& slot = localSlot();
+    slot.total.fetch_add(1, std::memory_order_relaxed);
+    slot.byStatus[static_cast<size_t>(status)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void TaskCounters::onStatusChange(const Task&, TaskStatus from, TaskStatus to) {
+    Slot& slot = localSlot();
+    slot.byStatus[static_cast<size_t>(from)].fetch_sub(1, std::memory_order_relaxed);
+    slot.byStatus[static_cast<size_t>(to)].fetch_add(1, std::memory_order_relaxed);
+}
+
+long long TaskCounters::getTotal() const {
+    long long sum = 0;
+    for (size_t i = 0; i < slotCount; ++i) {
+        sum += slots[i].total.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+long long TaskCounters::getCount(TaskStatus status) const {
+    long long sum = 0;
+    for (size_t i = 0; i < slotCount; ++i) {
+        sum += slots[i].byStatus[static_cast<size_t>(status)].load(std::memory_order_relaxed);
+    }
+    return sum;
+}
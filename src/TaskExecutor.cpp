@@ -0,0 +1,96 @@
+#include "../include/TaskExecutor.h"
+#include "../include/Task.h"
+#include "../include/loggingservice.h"
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <atomic>
+#include <sys/wait.h>
+
+namespace {
+// Where CpuExecutor publishes its result
+std::atomic<uint64_t> kernelSink(0);
+}  // namespace
+
+bool SleepExecutor::execute(Task& task) {
+    using namespace std::chrono;
+    long long total = duration_cast<milliseconds>(seconds(task.getDuration())).count();
+    long long slept = task.getCheckpoint();
+    auto start = steady_clock::now();
+    if (slept < total && task.waitForYieldRequest(milliseconds(total - slept))) {
+        task.yieldAt(slept + duration_cast<milliseconds>(steady_clock::now() - start).count());
+    }
+    return true;
+}
+
+CallableExecutor::CallableExecutor(std::function<bool()> work) : work(std::move(work)) {}
+
+bool CallableExecutor::execute(Task& task) {
+    try {
+        return work ? work() : true;
+    } catch (const std::exception& e) {
+        LOG_ERROR("Task ", task.getId(), " threw: ", e.what());
+        return false;
+    }
+}
+
+CpuExecutor::CpuExecutor(uint64_t iterations) : iterations(iterations) {}
+
+bool CpuExecutor::execute(Task& task) {
+    // splitmix64 rounds; the result is published so the loop can't be optimized away.
+    // A resumed run reseeds from the checkpoint: only the amount of work matters.
+    uint64_t done = static_cast<uint64_t>(task.getCheckpoint());
+    uint64_t state = static_cast<uint64_t>(task.getId()) ^ done;
+    for (uint64_t i = done; i < iterations; ++i) {
+        if ((i & 0xffff) == 0 && task.isYieldRequested()) {
+            kernelSink.store(state, std::memory_order_relaxed);
+            task.yieldAt(static_cast<long long>(i));
+            return true;
+        }
+        state += 0x9e3779b97f4a7c15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        state ^= z ^ (z >> 31);
+    }
+    kernelSink.store(state, std::memory_order_relaxed);
+    return true;
+}
+
+CommandExecutor::CommandExecutor(const std::string& command) : command(command) {}
+
+bool CommandExecutor::execute(Task& task) {
+    int status = std::system(command.c_str());
+    if (status == -1) {
+        LOG_ERROR("Task ", task.getId(), ": failed to start command");
+        return false;
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        LOG_ERROR("Task ", task.getId(), ": command exited with status ",
+                  WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<TaskExecutor> makeExecutor(const std::string& kind, const std::string& payload) {
+    if (kind.empty() || kind == "sleep") {
+        return std::make_shared<SleepExecutor>();
+    }
+    if (kind == "cpu") {
+        try {
+            size_t used = 0;
+            unsigned long long iterations = std::stoull(payload, &used);
+            if (used != payload.size()) {
+                return nullptr;
+            }
+            return std::make_shared<CpuExecutor>(iterations);
+        } catch (const std::exception&) {
+            return nullptr;
+        }
+    }
+    if (kind == "command") {
+        return payload.empty() ? nullptr : std::make_shared<CommandExecutor>(payload);
+    }
+    return nullptr;
+}
@@ -0,0 +1,134 @@
+#include "../include/TaskQueue.h"
+#include <algorithm>
+#include <iterator>
+
+TaskQueue::TaskQueue(std::chrono::milliseconds agingInterval)
+    : count(0), agingInterval(agingInterval), shortestJobFirst(false) {}
+
+void TaskQueue::setAgingInterval(std::chrono::milliseconds interval) {
+    agingInterval = interval;
+}
+
+void TaskQueue::setShortestJobFirst(bool enabled) {
+    if (enabled == shortestJobFirst) {
+        return;
+    }
+    shortestJobFirst = enabled;
+    // Rekey in the current order, so equal keys keep their relative order
+    for (auto& level : levels) {
+        Queue rekeyed;
+        for (auto& item : level.queue) {
+            auto entry = enabled
+                ? rekeyed.emplace(item.second.task->getDuration(), std::move(item.second))
+                : rekeyed.emplace_hint(rekeyed.end(), 0, std::move(item.second));
+            entry->second.arrival->entry = entry;
+        }
+        level.queue.swap(rekeyed);
+    }
+}
+
+void TaskQueue::push(const std::shared_ptr<Task>& task) {
+    // Clamped, since priorities also come back from the database
+    int level = std::min(std::max(static_cast<int>(task->getPriority()), 0), kLevels - 1);
+    insert(level, task, Clock::now());
+    count++;
+}
+
+std::shared_ptr<Task> TaskQueue::pop() {
+    if (count == 0) {
+        return nullptr;
+    }
+    age(Clock::now());
+    for (int level = kLevels - 1; level >= 0; --level) {
+        auto& queue = levels[level].queue;
+        if (!queue.empty()) {
+            count--;
+            return take(level, queue.begin());
+        }
+    }
+    return nullptr;
+}
+
+std::shared_ptr<Task> TaskQueue::popLeastUrgent() {
+    for (int level = 0; level < kLevels; ++level) {
+        auto& queue = levels[level].queue;
+        if (!queue.empty()) {
+            count--;
+            return take(level, std::prev(queue.end()));
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::shared_ptr<Task>> TaskQueue::takeAll() {
+    auto tasks = snapshot();
+    for (auto& level : levels) {
+        level.queue.clear();
+        level.arrivals.clear();
+    }
+    count = 0;
+    return tasks;
+}
+
+std::vector<std::shared_ptr<Task>> TaskQueue::snapshot() const {
+    std::vector<std::shared_ptr<Task>> tasks;
+    tasks.reserve(count);
+    for (int level = kLevels - 1; level >= 0; --level) {
+        for (const auto& item : levels[level].queue) {
+            tasks.push_back(item.second.task);
+        }
+    }
+    return tasks;
+}
+
+TaskPriority TaskQueue::topPriority() const {
+    for (int level = kLevels - 1; level > 0; --level) {
+        if (!levels[level].queue.empty()) {
+            return static_cast<TaskPriority>(level);
+        }
+    }
+    return TaskPriority::Low;
+}
+
+bool TaskQueue::empty() const {
+    return count == 0;
+}
+
+size_t TaskQueue::size() const {
+    return count;
+}
+
+void TaskQueue::insert(int level, std::shared_ptr<Task> task, Clock::time_point since) {
+    auto& target = levels[level];
+    auto arrival = target.arrivals.insert(target.arrivals.end(), Arrival{since, Queue::iterator()});
+    // Behind any queued task with the same key, so equal jobs stay in order
+    Queue::iterator entry;
+    if (shortestJobFirst) {
+        int duration = task->getDuration();
+        entry = target.queue.emplace(duration, Entry{std::move(task), arrival});
+    } else {
+        entry = target.queue.emplace_hint(target.queue.end(), 0, Entry{std::move(task), arrival});
+    }
+    arrival->entry = entry;
+}
+
+std::shared_ptr<Task> TaskQueue::take(int level, Queue::iterator entry) {
+    auto& source = levels[level];
+    auto task = std::move(entry->second.task);
+    source.arrivals.erase(entry->second.arrival);
+    source.queue.erase(entry);
+    return task;
+}
+
+void TaskQueue::age(Clock::time_point now) {
+    if (agingInterval.count() <= 0) {
+        return;
+    }
+    // Top down, so a task moves at most one level per pass
+    for (int level = kLevels - 2; level >= 0; --level) {
+        auto& arrivals = levels[level].arrivals;
+        while (!arrivals.empty() && now - arrivals.front().since >= agingInterval) {
+            insert(level + 1, take(level, arrivals.front().entry), now);
+        }
+    }
+}
@@ -0,0 +1,292 @@
+#include "../include/TimingWheel.h"
+#include "../include/loggingservice.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// First set bit in [begin, end) of a slot bitmap, or -1
+int findSet(const std::uint64_t* bits, int begin, int end) {
+    for (int i = begin; i < end; ) {
+        int word = i >> 6;
+        std::uint64_t value = bits[word] >> (i & 63);
+        if (value) {
+            int position = i + __builtin_ctzll(value);
+            return position < end ? position : -1;
+        }
+        i = (word + 1) << 6;
+    }
+    return -1;
+}
+
+}  // namespace
+
+TimingWheel::TimingWheel()
+    : epoch(Clock::now()), currentTick(0), freeList(-1), armed(0), plannedWake(-1), running(false) {
+    std::fill(std::begin(heads), std::end(heads), -1);
+    for (auto& level : occupied) {
+        std::fill(std::begin(level), std::end(level), 0);
+    }
+}
+
+TimingWheel::~TimingWheel() {
+    stop();
+}
+
+void TimingWheel::start() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (running) {
+        return;
+    }
+    running = true;
+    worker = std::thread(&TimingWheel::run, this);
+}
+
+void TimingWheel::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    cv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+TimingWheel::TimerId TimingWheel::schedule(std::chrono::milliseconds delay, Callback callback) {
+    return scheduleAt(Clock::now() + delay, std::move(callback));
+}
+
+TimingWheel::TimerId TimingWheel::scheduleAt(Clock::time_point when, Callback callback) {
+    long long deadline = tickOf(when);
+    std::lock_guard<std::mutex> lock(mtx);
+    std::int32_t index = allocateLocked(deadline, std::move(callback));
+    linkLocked(index);
+
+    // Only wake the worker if this timer is due before it planned to wake up
+    if (plannedWake != -1 && deadline < plannedWake) {
+        cv.notify_one();
+    }
+    return (static_cast<TimerId>(timers[index].generation) << 32) | static_cast<std::uint32_t>(index + 1);
+}
+
+bool TimingWheel::cancel(TimerId id) {
+    long long index = static_cast<long long>(id & 0xffffffffu) - 1;
+    std::uint32_t generation = static_cast<std::uint32_t>(id >> 32);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if (index < 0 || index >= static_cast<long long>(timers.size())) {
+        return false;
+    }
+    Timer& timer = timers[index];
+    if (timer.bucket == -1 || timer.generation != generation) {
+        return false;
+    }
+    unlinkLocked(static_cast<std::int32_t>(index));
+    releaseLocked(static_cast<std::int32_t>(index));
+    return true;
+}
+
+size_t TimingWheel::size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return armed;
+}
+
+long long TimingWheel::tickOf(Clock::time_point when) const {
+    // Round up so a timer never fires before its deadline
+    if (when <= epoch) {
+        return 0;
+    }
+    return std::chrono::ceil<std::chrono::milliseconds>(when - epoch).count();
+}
+
+void TimingWheel::run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    std::vector<Callback> fired;
+    while (running) {
+        long long now = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - epoch).count();
+        advanceLocked(now, fired);
+
+        if (!fired.empty()) {
+            lock.unlock();
+            for (auto& callback : fired) {
+                try {
+                    callback();
+                } catch (const std::exception& e) {
+                    LOG_ERROR("Timer callback failed: ", e.what());
+                }
+            }
+            fired.clear();
+            lock.lock();
+            continue;
+        }
+
+        // Sleep until the next occupied slot; nothing runs while timers wait
+        long long next = nextEventTickLocked();
+        if (next == -1) {
+            plannedWake = std::numeric_limits<long long>::max();
+            cv.wait(lock);
+        } else {
+            plannedWake = next;
+            cv.wait_until(lock, epoch + std::chrono::milliseconds(next));
+        }
+        plannedWake = -1;
+    }
+}
+
+std::int32_t TimingWheel::allocateLocked(long long deadline, Callback callback) {
+    std::int32_t index;
+    if (freeList != -1) {
+        index = freeList;
+        freeList = timers[index].next;
+    } else {
+        timers.push_back(Timer{0, nullptr, -1, -1, -1, 1});
+        index = static_cast<std::int32_t>(timers.size() - 1);
+    }
+    timers[index].deadline = deadline;
+    timers[index].callback = std::move(callback);
+    armed++;
+    return index;
+}
+
+void TimingWheel::releaseLocked(std::int32_t index) {
+    Timer& timer = timers[index];
+    timer.callback = nullptr;
+    timer.bucket = -1;
+    timer.prev = -1;
+    timer.generation++;  // Invalidates outstanding TimerIds for this slab entry
+    timer.next = freeList;
+    freeList = index;
+    armed--;
+}
+
+void TimingWheel::linkLocked(std::int32_t index) {
+    Timer& timer = timers[index];
+    int bucket = kDueBucket;
+    if (timer.deadline > currentTick) {
+        // Finest wheel whose window still reaches the deadline. Comparing
+        // slot numbers rather than the raw delay keeps the target slot
+        // distinct from the wheel's current slot.
+        int level = 0;
+        for (; level < kLevels; ++level) {
+            int shift = level * kSlotBits;
+            if ((timer.deadline >> shift) - (currentTick >> shift) < kSlots) {
+                bucket = level * kSlots + static_cast<int>((timer.deadline >> shift) & (kSlots - 1));
+                break;
+            }
+        }
+        if (level == kLevels) {
+            // Beyond the outermost wheel: park in its last slot and re-file later
+            int shift = (kLevels - 1) * kSlotBits;
+            bucket = (kLevels - 1) * kSlots + static_cast<int>(((currentTick >> shift) + kSlots - 1) & (kSlots - 1));
+        }
+    }
+
+    timer.bucket = bucket;
+    timer.prev = -1;
+    timer.next = heads[bucket];
+    if (timer.next != -1) {
+        timers[timer.next].prev = index;
+    }
+    heads[bucket] = index;
+    if (bucket < kDueBucket) {
+        int slot = bucket % kSlots;
+        occupied[bucket / kSlots][slot >> 6] |= std::uint64_t(1) << (slot & 63);
+    }
+}
+
+void TimingWheel::unlinkLocked(std::int32_t index) {
+    Timer& timer = timers[index];
+    if (timer.prev != -1) {
+        timers[timer.prev].next = timer.next;
+    } else {
+        heads[timer.bucket] = timer.next;
+    }
+    if (timer.next != -1) {
+        timers[timer.next].prev = timer.prev;
+    }
+    if (heads[timer.bucket] == -1 && timer.bucket < kDueBucket) {
+        int slot = timer.bucket % kSlots;
+        occupied[timer.bucket / kSlots][slot >> 6] &= ~(std::uint64_t(1) << (slot & 63));
+    }
+}
+
+std::int32_t TimingWheel::takeBucketLocked(int bucket) {
+    std::int32_t head = heads[bucket];
+    heads[bucket] = -1;
+    if (bucket < kDueBucket) {
+        int slot = bucket % kSlots;
+        occupied[bucket / kSlots][slot >> 6] &= ~(std::uint64_t(1) << (slot & 63));
+    }
+    return head;
+}
+
+long long TimingWheel::nextEventTickLocked() const {
+    if (heads[kDueBucket] != -1) {
+        return currentTick;
+    }
+
+    // Every occupied slot of a wheel comes due within the next kSlots - 1
+    // slots of that wheel, so the first one round from the current slot is next
+    long long best = -1;
+    for (int level = 0; level < kLevels; ++level) {
+        int shift = level * kSlotBits;
+        int current = static_cast<int>((currentTick >> shift) & (kSlots - 1));
+        int slot = findSet(occupied[level], current + 1, kSlots);
+        int distance = slot != -1 ? slot - current : 0;
+        if (slot == -1) {
+            slot = findSet(occupied[level], 0, current);
+            distance = slot != -1 ? slot + kSlots - current : 0;
+        }
+        if (distance == 0) {
+            continue;
+        }
+        long long tick = ((currentTick >> shift) + distance) << shift;
+        if (best == -1 || tick < best) {
+            best = tick;
+        }
+    }
+    return best;
+}
+
+void TimingWheel::advanceLocked(long long now, std::vector<Callback>& out) {
+    while (true) {
+        for (std::int32_t index = takeBucketLocked(kDueBucket); index != -1; ) {
+            std::int32_t next = timers[index].next;
+            out.push_back(std::move(timers[index].callback));
+            releaseLocked(index);
+            index = next;
+        }
+
+        // Jump straight to the next occupied slot; empty ticks are never visited
+        long long next = nextEventTickLocked();
+        if (next == -1 || next > now) {
+            currentTick = std::max(currentTick, now);
+            return;
+        }
+        processTickLocked(next);
+    }
+}
+
+void TimingWheel::processTickLocked(long long tick) {
+    currentTick = tick;
+
+    // Outer wheels first, so cascaded timers can land in the inner slots
+    // that come due at this same tick; then the innermost slot, whose timers
+    // are all due now and move to the due bucket
+    for (int level = kLevels - 1; level >= 0; --level) {
+        int shift = level * kSlotBits;
+        if ((tick & ((1LL << shift) - 1)) != 0) {
+            continue;
+        }
+        int bucket = level * kSlots + static_cast<int>((tick >> shift) & (kSlots - 1));
+        for (std::int32_t index = takeBucketLocked(bucket); index != -1; ) {
+            std::int32_t next = timers[index].next;
+            linkLocked(index);
+            index = next;
+        }
+    }
+}
@@ -87,7 +87,7 @@ LoadBalancer::~LoadBalancer() {
 
 void LoadBalancer::addWorkerNode(WorkerNode* node) {
     workerNodes.push_back(node);
-    LoggingService::getInstance()->info("Added worker node: " + node->getName());
+    LOG_INFO("Added worker node: ", node->getName());
 }
 
 void LoadBalancer::removeWorkerNode(int nodeId) {
@@ -95,7 +95,7 @@ void LoadBalancer::removeWorkerNode(int nodeId) {
                          [nodeId](const WorkerNode* node) { return node->getId() == nodeId; });
                          
     if (it != workerNodes.end()) {
-        LoggingService::getInstance()->info("Removed worker node: " + (*it)->getName());
+        LOG_INFO("Removed worker node: ", (*it)->getName());
         workerNodes.erase(it);
     }
 }
@@ -109,13 +109,13 @@ void LoadBalancer::setStrategy(LoadBalancingStrategy* newStrategy) {
 
 bool LoadBalancer::distributeTask(const Task& task) {
     if (workerNodes.empty()) {
-        LoggingService::getInstance()->warning("No worker nodes available to distribute task");
+        LOG_WARNING("No worker nodes available to distribute task");
         return false;
     }
     
     int selectedNodeId = strategy->selectWorkerNode(workerNodes, task);
     if (selectedNodeId == -1) {
-        LoggingService::getInstance()->warning("Failed to select worker node for task");
+        LOG_WARNING("Failed to select worker node for task");
         return false;
     }
     
@@ -129,14 +129,13 @@ bool LoadBalancer::distributeTask(const Task& task) {
     }
     
     if (!selectedNode) {
-        LoggingService::getInstance()->error("Selected node ID not found");
+        LOG_ERROR("Selected node ID not found");
         return false;
     }
     
     // Add task to the selected node
     selectedNode->addTask(task);
-    LoggingService::getInstance()->info("Task #" + std::to_string(task.getId()) + 
-                                    " assigned to node " + selectedNode->getName());
+    LOG_INFO("Task #", task.getId(), " assigned to node ", selectedNode->getName());
     return true;
 }
 
@@ -2,89 +2,314 @@
 #include "../include/loggingservice.h"
 #include <iostream>
 #include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+
+// One log call in async mode; sized so a record is four cache lines
+struct LoggingService::Record {
+    static constexpr size_t kTextSize = 240;
+    long long micros;  // system_clock time since the epoch
+    LogLevel level;
+    uint16_t length;
+    char text[kTextSize];
+};
+
+// Single-producer (the owning thread), single-consumer (whoever holds
+// drainMutex) ring of records
+struct LoggingService::Ring {
+    explicit Ring(size_t capacity) : records(capacity), mask(capacity - 1), head(0), tail(0), retired(false) {}
+
+    std::vector<Record> records;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head;  // next slot the producer writes
+    alignas(64) std::atomic<size_t> tail;  // next slot the consumer reads
+    // The owning thread has exited; freed once drained
+    std::atomic<bool> retired;
+};
+
+namespace {
+
+// How often the writer drains the rings when nothing asks it to
+const std::chrono::milliseconds kWriterInterval(5);
+
+// Marks the calling thread's ring retired when the thread exits
+struct RingHandle {
+    std::atomic<bool>* retired = nullptr;
+    void* ring = nullptr;
+    ~RingHandle() {
+        if (retired) retired->store(true, std::memory_order_release);
+    }
+};
+thread_local RingHandle localHandle;
+
+}  // namespace
 
 // Initialize static instance pointer
 LoggingService* LoggingService::instance = nullptr;
 
-// Singleton implementation
+// Singleton implementation; node threads may be the first to log
 LoggingService* LoggingService::getInstance() {
-    if (instance == nullptr) {
-        instance = new LoggingService();
-    }
+    static std::once_flag created;
+    std::call_once(created, [] { instance = new LoggingService(); });
     return instance;
 }
 
-LoggingService::LoggingService() : minLevel(LogLevel::INFO) {
+LoggingService::LoggingService()
+    : historyCapacity(kDefaultHistoryCapacity), minLevel(LogLevel::INFO), async(false),
+      ringCapacity(kDefaultRingCapacity), dropped(0), droppedReported(0), stopWriter(false), cachedSecond(-1) {
     // Initialize with empty log
 }
 
 LoggingService::~LoggingService() {
+    setAsync(false);
     if (logFile.is_open()) {
         logFile.close();
     }
 }
 
-void LoggingService::log(LogLevel level, const std::string& message) {
-    if (level < minLevel) {
+const char* LoggingService::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARNING: return "WARNING";
+        case LogLevel::ERROR: return "ERROR";
+        case LogLevel::CRITICAL: return "CRITICAL";
+        default: return "UNKNOWN";
+    }
+}
+
+void LoggingService::log(LogLevel level, std::string_view message) {
+    if (level < minLevel.load(std::memory_order_relaxed)) {
         return;
     }
-    
-    // Get current time
+
     auto now = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    
-    // Convert level to string
-    std::string levelStr;
-    switch (level) {
-        case LogLevel::DEBUG: levelStr = "DEBUG"; break;
-        case LogLevel::INFO: levelStr = "INFO"; break;
-        case LogLevel::WARNING: levelStr = "WARNING"; break;
-        case LogLevel::ERROR: levelStr = "ERROR"; break;
-        case LogLevel::CRITICAL: levelStr = "CRITICAL"; break;
-        default: levelStr = "UNKNOWN"; break;
-    }
-    
+
+    if (async.load(std::memory_order_relaxed)) {
+        Ring* ring = localRing();
+        size_t head = ring->head.load(std::memory_order_relaxed);
+        size_t queued = head - ring->tail.load(std::memory_order_acquire);
+        if (queued > ring->mask) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        Record& record = ring->records[head & ring->mask];
+        record.micros = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+        record.level = level;
+        record.length = static_cast<uint16_t>(std::min(message.size(), Record::kTextSize));
+        std::memcpy(record.text, message.data(), record.length);
+        ring->head.store(head + 1, std::memory_order_release);
+        // Wake the writer early once a ring is half full, rather than
+        // waiting out its interval and dropping
+        if (queued + 1 == (ring->mask + 1) / 2) {
+            writerCv.notify_one();
+        }
+        return;
+    }
+
+    // Get current time
+    std::time_t time = std::chrono::system_clock::to_time_t(now);
+    std::tm local;
+    localtime_r(&time, &local);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+
     // Format log message
-    std::string logMessage = ss.str() + " [" + levelStr + "] " + message;
-    
+    std::string logMessage = std::string(stamp) + " [" + levelName(level) + "] " + std::string(message);
+
     // Lock for thread safety
     std::lock_guard<std::mutex> lock(logMutex);
-    
-    // Add to in-memory logs
-    logs.push_back(logMessage);
-    
+
     // Print to console
     std::cout << logMessage << std::endl;
-    
+
     // Write to file if open
     if (logFile.is_open()) {
         logFile << logMessage << std::endl;
         logFile.flush();
     }
+
+    // Add to in-memory logs
+    rememberLocked(std::move(logMessage));
+}
+
+LoggingService::Ring* LoggingService::localRing() {
+    if (localHandle.ring) {
+        return static_cast<Ring*>(localHandle.ring);
+    }
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    rings.push_back(std::make_unique<Ring>(ringCapacity));
+    localHandle.ring = rings.back().get();
+    localHandle.retired = &rings.back()->retired;
+    return rings.back().get();
+}
+
+void LoggingService::setAsync(bool enabled, size_t capacity) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    if (enabled) {
+        size_t rounded = 2;
+        while (rounded < capacity) rounded <<= 1;
+        {
+            std::lock_guard<std::mutex> ringsLock(ringsMutex);
+            ringCapacity = rounded;
+        }
+        if (!writer.joinable()) {
+            stopWriter = false;
+            writer = std::thread(&LoggingService::writerLoop, this);
+        }
+        async = true;
+        return;
+    }
+
+    async = false;
+    if (writer.joinable()) {
+        stopWriter = true;
+        writerCv.notify_all();
+        // Unlocked so the writer can see stopWriter; setAsync calls are not concurrent
+        writerMutex.unlock();
+        writer.join();
+        writerMutex.lock();
+    }
+    flush();
 }
 
-void LoggingService::debug(const std::string& message) {
+bool LoggingService::isAsync() const {
+    return async.load();
+}
+
+void LoggingService::writerLoop() {
+    std::unique_lock<std::mutex> lock(writerMutex);
+    while (!stopWriter) {
+        writerCv.wait_for(lock, kWriterInterval);
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+void LoggingService::flush() {
+    std::lock_guard<std::mutex> lock(drainMutex);
+    drainLocked();
+}
+
+void LoggingService::drainLocked() {
+    // Collect from every ring, then order by time across threads
+    std::vector<const Record*> batch;
+    std::vector<std::pair<Ring*, size_t>> consumed;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        for (auto& ring : rings) {
+            size_t tail = ring->tail.load(std::memory_order_relaxed);
+            size_t head = ring->head.load(std::memory_order_acquire);
+            for (size_t i = tail; i != head; ++i) {
+                batch.push_back(&ring->records[i & ring->mask]);
+            }
+            if (head != tail) {
+                consumed.emplace_back(ring.get(), head);
+            }
+        }
+    }
+    unsigned long long droppedNow = dropped.load(std::memory_order_relaxed);
+    if (batch.empty() && droppedNow == droppedReported) {
+        return;
+    }
+    std::stable_sort(batch.begin(), batch.end(),
+        [](const Record* a, const Record* b) { return a->micros < b->micros; });
+
+    std::vector<std::string> lines;
+    lines.reserve(batch.size() + 1);
+    std::string out;
+    for (const Record* record : batch) {
+        std::string line = stampLocked(record->micros) + " [" + levelName(record->level) + "] ";
+        line.append(record->text, record->length);
+        out += line;
+        out += '\n';
+        lines.push_back(std::move(line));
+    }
+    if (droppedNow != droppedReported) {
+        long long now = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        std::string line = stampLocked(now) + " [WARNING] " + std::to_string(droppedNow - droppedReported) +
+                           " log records dropped (ring buffer full)";
+        out += line;
+        out += '\n';
+        lines.push_back(std::move(line));
+        droppedReported = droppedNow;
+    }
+
+    // The records are copied out; hand the slots back to their producers
+    for (auto& entry : consumed) {
+        entry.first->tail.store(entry.second, std::memory_order_release);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(logMutex);
+        std::cout << out;
+        std::cout.flush();
+        if (logFile.is_open()) {
+            logFile << out;
+            logFile.flush();
+        }
+        for (auto& line : lines) {
+            rememberLocked(std::move(line));
+        }
+    }
+
+    // Free the rings of threads that have exited, once they are empty
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    rings.erase(std::remove_if(rings.begin(), rings.end(), [](const std::unique_ptr<Ring>& ring) {
+        return ring->retired.load(std::memory_order_acquire) &&
+               ring->tail.load(std::memory_order_relaxed) == ring->head.load(std::memory_order_acquire);
+    }), rings.end());
+}
+
+const std::string& LoggingService::stampLocked(long long micros) {
+    long long second = micros / 1000000;
+    if (second != cachedSecond) {
+        std::time_t time = static_cast<std::time_t>(second);
+        std::tm local;
+        localtime_r(&time, &local);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+        cachedSecond = second;
+        cachedStamp = stamp;
+    }
+    return cachedStamp;
+}
+
+void LoggingService::rememberLocked(std::string line) {
+    if (historyCapacity == 0) {
+        return;
+    }
+    if (logs.size() >= historyCapacity) {
+        logs.pop_front();
+    }
+    logs.push_back(std::move(line));
+}
+
+std::string& LoggingService::formatBuffer() {
+    thread_local std::string buffer;
+    return buffer;
+}
+
+void LoggingService::debug(std::string_view message) {
     log(LogLevel::DEBUG, message);
 }
 
-void LoggingService::info(const std::string& message) {
+void LoggingService::info(std::string_view message) {
     log(LogLevel::INFO, message);
 }
 
-void LoggingService::warning(const std::string& message) {
+void LoggingService::warning(std::string_view message) {
     log(LogLevel::WARNING, message);
 }
 
-void LoggingService::error(const std::string& message) {
+void LoggingService::error(std::string_view message) {
     log(LogLevel::ERROR, message);
 }
 
-void LoggingService::critical(const std::string& message) {
+void LoggingService::critical(std::string_view message) {
     log(LogLevel::CRITICAL, message);
 }
 
@@ -93,31 +318,44 @@ void LoggingService::setMinLogLevel(LogLevel level) {
 }
 
 void LoggingService::setLogFile(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(logMutex);
     if (logFile.is_open()) {
         logFile.close();
     }
-    
+
     logFile.open(filename, std::ios::app);
     if (!logFile.is_open()) {
         std::cerr << "Failed to open log file: " << filename << std::endl;
     }
 }
 
+void LoggingService::setHistoryCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    historyCapacity = capacity;
+    while (logs.size() > historyCapacity) {
+        logs.pop_front();
+    }
+}
+
+unsigned long long LoggingService::getDroppedCount() const {
+    return dropped.load();
+}
+
 std::vector<std::string> LoggingService::getRecentLogs(int count) const {
     std::lock_guard<std::mutex> lock(logMutex);
-    
+
     if (count <= 0 || logs.empty()) {
         return {};
     }
-    
-    if (count >= logs.size()) {
-        return logs;
+
+    if (static_cast<size_t>(count) >= logs.size()) {
+        return std::vector<std::string>(logs.begin(), logs.end());
     }
-    
+
     return std::vector<std::string>(logs.end() - count, logs.end());
 }
 
 void LoggingService::clearLogs() {
     std::lock_guard<std::mutex> lock(logMutex);
     logs.clear();
-}
\ No newline at end of file
+}
@@ -2,14 +2,27 @@
 #include "FIFOScheduler.h"
 #include "../include/crow.h"
 #include "Node.h"
+#include "DatabaseManager.h"
+#include "EventBroadcaster.h"
+#include "TaskExecutor.h"
+#include "loggingservice.h"
+#include "HttpMetrics.h"
 #include <string>
 #include <memory>
 #include <signal.h>
 #include <atomic>
+#include <algorithm>
+#include <optional>
+#include <sstream>
+#include <cstdlib>
+#include <chrono>
+#include <charconv>
 
 // Global flag for clean shutdown
 std::atomic<bool> should_exit(false);
-crow::SimpleApp* app_ptr = nullptr;
+// The app times every request through the HttpMetrics middleware
+using App = crow::App<HttpMetrics>;
+App* app_ptr = nullptr;
 
 // Signal handler for clean shutdown
 void signal_handler(int signal) {
@@ -29,18 +42,148 @@ void add_cors_headers(crow::response& res) {
     res.add_header("Access-Control-Allow-Headers", "Content-Type");
 }
 
+// Reads the optional "executor"/"payload" fields of a submitted task.
+// Returns an error message, or an empty string on success.
+std::string parseExecutor(const crow::json::rvalue& body, bool allowCommands,
+                          std::shared_ptr<TaskExecutor>& executor) {
+    if (!body.has("executor")) {
+        return "";
+    }
+    if (body["executor"].t() != crow::json::type::String) {
+        return "executor must be a string";
+    }
+    std::string kind = body["executor"].s();
+    std::string payload;
+    if (body.has("payload")) {
+        if (body["payload"].t() == crow::json::type::String) {
+            payload = body["payload"].s();
+        } else if (body["payload"].t() == crow::json::type::Number) {
+            payload = std::to_string(body["payload"].i());
+        } else {
+            return "payload must be a string or a number";
+        }
+    }
+    if (kind == "command" && !allowCommands) {
+        return "Command tasks are disabled (start the backend with TASKMASTER_ALLOW_COMMANDS=1)";
+    }
+    executor = makeExecutor(kind, payload);
+    if (!executor) {
+        return "Invalid executor '" + kind + "' or payload";
+    }
+    return "";
+}
+
+// Reads the optional integer query parameter `name` into value, which is
+// left unchanged when the parameter is absent. Returns an error message, or
+// an empty string on success.
+std::string parseIntParam(const crow::request& req, const char* name, long long min, long long max,
+                          long long& value) {
+    const char* text = req.url_params.get(name);
+    if (!text) {
+        return "";
+    }
+    const char* end = text + std::char_traits<char>::length(text);
+    long long parsed = 0;
+    auto result = std::from_chars(text, end, parsed);
+    if (result.ec != std::errc() || result.ptr != end || parsed < min || parsed > max) {
+        return std::string("Invalid ") + name + ": expected an integer from " + std::to_string(min) +
+               " to " + std::to_string(max);
+    }
+    value = parsed;
+    return "";
+}
+
+// Reads the optional "run_at" (Unix time in ms) or "delay_ms" field of a
+// submitted task into runAt (0 when neither is given). Returns an error
+// message, or an empty string on success.
+std::string parseRunAt(const crow::json::rvalue& body, long long& runAt) {
+    runAt = 0;
+    if (body.has("run_at") && body.has("delay_ms")) {
+        return "Give either run_at or delay_ms, not both";
+    }
+    for (const char* field : {"run_at", "delay_ms"}) {
+        if (!body.has(field)) {
+            continue;
+        }
+        if (body[field].t() != crow::json::type::Number || body[field].i() < 0) {
+            return std::string(field) + " must be a non-negative number of milliseconds";
+        }
+        runAt = body[field].i();
+    }
+    if (body.has("delay_ms") && runAt > 0) {
+        runAt += std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+    return "";
+}
+
+// Reads the optional "priority" field of a submitted task: "low", "medium"
+// (default), "high", "critical" or the matching number 0-3. Returns an
+// error message, or an empty string on success.
+std::string parsePriority(const crow::json::rvalue& body, TaskPriority& priority) {
+    priority = TaskPriority::Medium;
+    if (!body.has("priority")) {
+        return "";
+    }
+    const char* names[] = {"low", "medium", "high", "critical"};
+    const auto& field = body["priority"];
+    if (field.t() == crow::json::type::Number && field.i() >= 0 && field.i() <= 3) {
+        priority = static_cast<TaskPriority>(field.i());
+        return "";
+    }
+    if (field.t() == crow::json::type::String) {
+        for (int level = 0; level < 4; ++level) {
+            if (std::string(field.s()) == names[level]) {
+                priority = static_cast<TaskPriority>(level);
+                return "";
+            }
+        }
+    }
+    return "priority must be low, medium, high, critical or 0-3";
+}
+
+const char* preemptionName(PreemptionPolicy policy) {
+    switch (policy) {
+        case PreemptionPolicy::Critical: return "critical";
+        case PreemptionPolicy::HigherPriority: return "priority";
+        default: return "off";
+    }
+}
+
 int main() {
     // Set up signal handlers
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
+    // Backend log verbosity: debug, info (default), warning, error or critical
+    if (const char* level = std::getenv("TASKMASTER_LOG_LEVEL")) {
+        const char* names[] = {"debug", "info", "warning", "error", "critical"};
+        for (int i = 0; i < 5; ++i) {
+            if (std::string(level) == names[i]) {
+                LoggingService::getInstance()->setMinLogLevel(static_cast<LogLevel>(i));
+            }
+        }
+    }
+    // Log calls only queue the message; a writer thread formats and writes it
+    const char* logAsync = std::getenv("TASKMASTER_LOG_ASYNC");
+    if (logAsync && std::string(logAsync) == "1") {
+        LoggingService::getInstance()->setAsync(true);
+    }
+
     // Create Crow app
-    crow::SimpleApp app;
+    App app;
     app_ptr = &app;
     
     // Initialize TaskManager with database
     auto scheduler = std::make_unique<FIFOScheduler>();
     auto manager = std::make_shared<TaskManager>(std::move(scheduler), "taskmaster.db");
+
+    // Command tasks run arbitrary shell commands on this host, so accepting
+    // them over HTTP, or rerunning saved ones after a restart, has to be
+    // switched on explicitly
+    const char* allowCommandsEnv = std::getenv("TASKMASTER_ALLOW_COMMANDS");
+    const bool allowCommands = allowCommandsEnv && std::string(allowCommandsEnv) == "1";
+    manager->setAllowCommands(allowCommands);
     
     // Initialize the TaskManager (load from database)
     if (!manager->initialize()) {
@@ -48,6 +191,15 @@ int main() {
         return 1;
     }
 
+    // Executor slots for nodes added without an explicit count
+    if (const char* slots = std::getenv("TASKMASTER_NODE_SLOTS")) {
+        manager->setDefaultNodeSlots(static_cast<size_t>(std::max(std::atoi(slots), 1)));
+    }
+
+    // Live task/node events for /ws clients
+    EventBroadcaster broadcaster(*manager);
+    broadcaster.start();
+
     // --- CORS preflight handlers ---
     CROW_ROUTE(app, "/add_node").methods("OPTIONS"_method)(
         [](const crow::request&, crow::response& res) {
@@ -63,6 +215,13 @@ int main() {
             res.end();
         });
 
+    CROW_ROUTE(app, "/add_tasks").methods("OPTIONS"_method)(
+        [](const crow::request&, crow::response& res) {
+            res.code = 200;
+            add_cors_headers(res);
+            res.end();
+        });
+
     CROW_ROUTE(app, "/tasks").methods("OPTIONS"_method)(
         [](const crow::request&, crow::response& res) {
             res.code = 200;
@@ -98,6 +257,34 @@ int main() {
             res.end();
         });
 
+    CROW_ROUTE(app, "/backlog").methods("OPTIONS"_method)(
+        [](const crow::request&, crow::response& res) {
+            res.code = 200;
+            add_cors_headers(res);
+            res.end();
+        });
+
+    CROW_ROUTE(app, "/changes").methods("OPTIONS"_method)(
+        [](const crow::request&, crow::response& res) {
+            res.code = 200;
+            add_cors_headers(res);
+            res.end();
+        });
+
+    CROW_ROUTE(app, "/tasks/<int>/timeline").methods("OPTIONS"_method)(
+        [](const crow::request&, crow::response& res, int) {
+            res.code = 200;
+            add_cors_headers(res);
+            res.end();
+        });
+
+    CROW_ROUTE(app, "/task_latency").methods("OPTIONS"_method)(
+        [](const crow::request&, crow::response& res) {
+            res.code = 200;
+            add_cors_headers(res);
+            res.end();
+        });
+
     // --- New Route for remove_node ---
     CROW_ROUTE(app, "/remove_node").methods("POST"_method)(
         [manager](const crow::request& req, crow::response& res) {
@@ -127,14 +314,18 @@ int main() {
 
 
     // --- Actual Routes ---
+    // Optional body: {"slots": n} executor slots for the new node
     CROW_ROUTE(app, "/add_node").methods("POST"_method)(
-        [manager](const crow::request&, crow::response& res) {
+        [manager](const crow::request& req, crow::response& res) {
             try {
-                manager->addNode();
+                size_t slots = 0;
+                auto body = crow::json::load(req.body);
+                if (body && body.t() == crow::json::type::Object && body.has("slots")) {
+                    slots = static_cast<size_t>(std::max<int64_t>(body["slots"].i(), 0));
+                }
                 
                 // Return the newly created node ID
-                auto nodes = manager->getAllNodes();
-                int newNodeId = nodes.empty() ? 0 : nodes.back()->getId();
+                int newNodeId = manager->addNode(slots);
                 
                 crow::json::wvalue result;
                 result["message"] = "Node added";
@@ -152,8 +343,11 @@ int main() {
             }
         });
 
+    // Optional executor fields on a task (see TaskExecutor.h):
+    //   "executor": "sleep" (default) | "cpu" | "command", "payload": ...
+    //   "priority": "low" | "medium" (default) | "high" | "critical", or 0-3
     CROW_ROUTE(app, "/add_task").methods("POST"_method)(
-        [manager](const crow::request& req, crow::response& res) {
+        [manager, allowCommands](const crow::request& req, crow::response& res) {
             try {
                 auto body = crow::json::load(req.body);
                 if (!body) {
@@ -166,13 +360,33 @@ int main() {
 
                 std::string name = body["name"].s();
                 int duration = body["duration"].i();
-                manager->addTask(name, duration);
+                std::shared_ptr<TaskExecutor> executor;
+                long long runAt = 0;
+                TaskPriority priority = TaskPriority::Medium;
+                std::string error = parseExecutor(body, allowCommands, executor);
+                if (error.empty()) {
+                    error = parseRunAt(body, runAt);
+                }
+                if (error.empty()) {
+                    error = parsePriority(body, priority);
+                }
+                if (!error.empty()) {
+                    res.code = 400;
+                    res.write(error);
+                    add_cors_headers(res);
+                    res.end();
+                    return;
+                }
+                int taskId = manager->addTask(name, duration, executor, runAt, priority);
                 
                 // Return success message
                 crow::json::wvalue result;
                 result["message"] = "Task added successfully";
+                result["id"] = taskId;
                 result["name"] = name;
                 result["duration"] = duration;
+                result["run_at"] = runAt;
+                result["priority"] = static_cast<int>(priority);
                 
                 res = crow::response(result);
                 res.code = 200;
@@ -186,18 +400,181 @@ int main() {
             }
         });
 
+    // Bulk submission. The body is either a JSON array of
+    // {"name": ..., "duration": ...} objects or the same objects as NDJSON
+    // (one per line); each takes the optional fields of /add_task. Responds
+    // with the new ids in submission order.
+    CROW_ROUTE(app, "/add_tasks").methods("POST"_method)(
+        [manager, allowCommands](const crow::request& req, crow::response& res) {
+            const size_t maxBatch = TaskManager::kMaxBatchSize;
+            try {
+                std::vector<TaskSpec> specs;
+                auto parseSpec = [&specs, allowCommands](const crow::json::rvalue& item) {
+                    if (item.t() != crow::json::type::Object || !item.has("name") || !item.has("duration") ||
+                        item["name"].t() != crow::json::type::String || item["duration"].t() != crow::json::type::Number) {
+                        return false;
+                    }
+                    std::shared_ptr<TaskExecutor> executor;
+                    TaskPriority priority;
+                    long long runAt;
+                    if (!parseExecutor(item, allowCommands, executor).empty() ||
+                        !parsePriority(item, priority).empty() || !parseRunAt(item, runAt).empty()) {
+                        return false;
+                    }
+                    specs.push_back(TaskSpec{item["name"].s(), static_cast<int>(item["duration"].i()), executor,
+                                             priority, runAt});
+                    return true;
+                };
+
+                size_t start = req.body.find_first_not_of(" \t\r\n");
+                bool isArray = start != std::string::npos && req.body[start] == '[';
+                std::string error;
+                if (isArray) {
+                    auto body = crow::json::load(req.body);
+                    if (!body || body.t() != crow::json::type::List) {
+                        error = "Invalid JSON array";
+                    } else if (body.size() > maxBatch) {
+                        error = "Too many tasks in one request";
+                    } else {
+                        specs.reserve(body.size());
+                        for (size_t i = 0; i < body.size() && error.empty(); ++i) {
+                            if (!parseSpec(body[i])) {
+                                error = "Invalid task at index " + std::to_string(i);
+                            }
+                        }
+                    }
+                } else {
+                    std::istringstream lines(req.body);
+                    std::string line;
+                    size_t lineNumber = 0;
+                    while (error.empty() && std::getline(lines, line)) {
+                        lineNumber++;
+                        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+                            continue;
+                        }
+                        auto item = crow::json::load(line);
+                        if (!item || !parseSpec(item)) {
+                            error = "Invalid task on line " + std::to_string(lineNumber);
+                        } else if (specs.size() > maxBatch) {
+                            error = "Too many tasks in one request";
+                        }
+                    }
+                }
+
+                if (error.empty() && specs.empty()) {
+                    error = "No tasks given";
+                }
+                if (!error.empty()) {
+                    res.code = 400;
+                    res.write(error);
+                    add_cors_headers(res);
+                    res.end();
+                    return;
+                }
+
+                std::vector<int> ids = manager->addTasks(specs);
+
+                crow::json::wvalue result;
+                result["message"] = "Tasks added successfully";
+                result["count"] = ids.size();
+                result["ids"] = ids;
+
+                res = crow::response(result);
+                res.code = 200;
+                add_cors_headers(res);
+                res.end();
+            } catch (const std::exception& e) {
+                res.code = 500;
+                res.write(std::string("Error adding tasks: ") + e.what());
+                add_cors_headers(res);
+                res.end();
+            }
+        });
+
+    // Keyset-paginated task listing:
+    //   /tasks?after_id=<cursor>&limit=<n>&status=pending|running|completed
+    // returns {"tasks": [...], "next_after_id": <cursor or null>}. The full,
+    // unpaginated array is only returned for /tasks?all=true.
     CROW_ROUTE(app, "/tasks").methods("GET"_method)(
-        [manager](const crow::request&, crow::response& res) {
+        [manager](const crow::request& req, crow::response& res) {
             try {
-                auto tasks = manager->getAllTasks();
+                auto taskJson = [](const std::shared_ptr<Task>& task) {
+                    crow::json::wvalue item;
+                    item["id"] = task->getId();
+                    item["name"] = task->getName();
+                    item["duration"] = task->getDuration();
+                    item["status"] = static_cast<int>(task->getStatus());
+                    auto executor = task->getExecutor();
+                    item["executor"] = executor ? executor->kind() : "sleep";
+                    item["failed"] = task->hasFailed();
+                    item["run_at"] = task->getRunAt();
+                    item["priority"] = static_cast<int>(task->getPriority());
+                    return item;
+                };
+
+                const char* all = req.url_params.get("all");
+                if (all && std::string(all) == "true") {
+                    auto tasks = manager->getAllTasks();
+                    crow::json::wvalue result;
+                    int i = 0;
+                    for (const auto& task : tasks) {
+                        result[i] = taskJson(task);
+                        i++;
+                    }
+                    res = crow::response(result);
+                    res.code = 200;
+                    add_cors_headers(res);
+                    res.end();
+                    return;
+                }
+
+                const long long defaultLimit = 100;
+                const long long maxLimit = 1000;
+                long long afterId = 0;
+                long long requestedLimit = defaultLimit;
+                std::optional<TaskStatus> status;
+                std::string error = parseIntParam(req, "after_id", 0, INT32_MAX, afterId);
+                if (error.empty()) {
+                    error = parseIntParam(req, "limit", 1, INT32_MAX, requestedLimit);
+                }
+                if (!error.empty()) {
+                    res.code = 400;
+                    res.write(error);
+                    add_cors_headers(res);
+                    res.end();
+                    return;
+                }
+                size_t limit = static_cast<size_t>(std::min(requestedLimit, maxLimit));
+                if (const char* value = req.url_params.get("status")) {
+                    std::string name = value;
+                    if (name == "pending" || name == "0") {
+                        status = TaskStatus::Pending;
+                    } else if (name == "running" || name == "1") {
+                        status = TaskStatus::Running;
+                    } else if (name == "completed" || name == "2") {
+                        status = TaskStatus::Completed;
+                    } else {
+                        res.code = 400;
+                        res.write("Invalid status: use pending, running or completed");
+                        add_cors_headers(res);
+                        res.end();
+                        return;
+                    }
+                }
+
+                TaskPage page = manager->getTasksPage(static_cast<int>(afterId), limit, status);
+                std::vector<crow::json::wvalue> items;
+                items.reserve(page.tasks.size());
+                for (const auto& task : page.tasks) {
+                    items.push_back(taskJson(task));
+                }
+
                 crow::json::wvalue result;
-                int i = 0;
-                for (const auto& task : tasks) {
-                    result[i]["id"] = task->getId();
-                    result[i]["name"] = task->getName();
-                    result[i]["duration"] = task->getDuration();
-                    result[i]["status"] = static_cast<int>(task->getStatus());
-                    i++;
+                result["tasks"] = std::move(items);
+                if (page.nextAfterId != -1) {
+                    result["next_after_id"] = page.nextAfterId;
+                } else {
+                    result["next_after_id"] = nullptr;
                 }
                 res = crow::response(result);
                 res.code = 200;
@@ -262,6 +639,10 @@ int main() {
                     type = SchedulerType::RoundRobin;
                 } else if (schedulerType == "loadbalanced") {
                     type = SchedulerType::LoadBalanced;
+                } else if (schedulerType == "p2c") {
+                    type = SchedulerType::PowerOfTwoChoices;
+                } else if (schedulerType == "leastwork") {
+                    type = SchedulerType::LeastWork;
                 } else {
                     res.code = 400;
                     res.write("Invalid scheduler type");
@@ -270,6 +651,55 @@ int main() {
                     return;
                 }
                 
+                // Optional shortest-job-first ordering of the nodes' queues
+                if (body.has("sjf")) {
+                    if (body["sjf"].t() != crow::json::type::True && body["sjf"].t() != crow::json::type::False) {
+                        res.code = 400;
+                        res.write("sjf must be true or false");
+                        add_cors_headers(res);
+                        res.end();
+                        return;
+                    }
+                    manager->setShortestJobFirst(body["sjf"].b());
+                }
+                
+                // Optional preemption policy ("off", "critical", "priority")
+                // and per-task budget
+                if (body.has("preemption") || body.has("preemption_budget")) {
+                    PreemptionPolicy policy = manager->getPreemptionPolicy();
+                    int budget = manager->getPreemptionBudget();
+                    std::string error;
+                    if (body.has("preemption")) {
+                        std::string name = body["preemption"].t() == crow::json::type::String
+                            ? std::string(body["preemption"].s()) : "";
+                        if (name == "off") {
+                            policy = PreemptionPolicy::Off;
+                        } else if (name == "critical") {
+                            policy = PreemptionPolicy::Critical;
+                        } else if (name == "priority") {
+                            policy = PreemptionPolicy::HigherPriority;
+                        } else {
+                            error = "preemption must be off, critical or priority";
+                        }
+                    }
+                    if (body.has("preemption_budget")) {
+                        if (body["preemption_budget"].t() != crow::json::type::Number ||
+                            body["preemption_budget"].i() < 0) {
+                            error = "preemption_budget must be a non-negative number";
+                        } else {
+                            budget = static_cast<int>(body["preemption_budget"].i());
+                        }
+                    }
+                    if (!error.empty()) {
+                        res.code = 400;
+                        res.write(error);
+                        add_cors_headers(res);
+                        res.end();
+                        return;
+                    }
+                    manager->setPreemption(policy, budget);
+                }
+                
                 // Perform the scheduler change
                 manager->setScheduler(type);
                 
@@ -278,6 +708,9 @@ int main() {
                 result["message"] = "Scheduler updated";
                 result["type"] = schedulerType;
                 result["name"] = manager->getCurrentSchedulerName();
+                result["sjf"] = manager->isShortestJobFirst();
+                result["preemption"] = preemptionName(manager->getPreemptionPolicy());
+                result["preemption_budget"] = manager->getPreemptionBudget();
                 
                 // Set the response directly
                 res = crow::response(result);
@@ -317,11 +750,20 @@ int main() {
                     case SchedulerType::LoadBalanced:
                         typeName = "loadbalanced";
                         break;
+                    case SchedulerType::PowerOfTwoChoices:
+                        typeName = "p2c";
+                        break;
+                    case SchedulerType::LeastWork:
+                        typeName = "leastwork";
+                        break;
                 }
                 
                 crow::json::wvalue result;
                 result["type"] = typeName;
                 result["name"] = manager->getCurrentSchedulerName();
+                result["sjf"] = manager->isShortestJobFirst();
+                result["preemption"] = preemptionName(manager->getPreemptionPolicy());
+                result["preemption_budget"] = manager->getPreemptionBudget();
                 
                 // Set the response directly
                 res = crow::response(result);
@@ -337,8 +779,10 @@ int main() {
         });
 
     // New route for database statistics
+    // Counts come from TaskManager's in-memory counters; pass ?verify=1 to
+    // also run the COUNT(*) queries and compare
     CROW_ROUTE(app, "/db_stats").methods("GET"_method)(
-        [manager](const crow::request&, crow::response& res) {
+        [manager](const crow::request& req, crow::response& res) {
             try {
                 crow::json::wvalue result;
                 result["total_tasks"] = manager->getTotalTaskCount();
@@ -347,6 +791,39 @@ int main() {
                 result["completed_tasks"] = manager->getCompletedTaskCount();
                 result["total_nodes"] = manager->getTotalNodeCount();
                 
+                // Group-commit counters from the database writer
+                BatchStats batch = manager->getDbManager()->getBatchStats();
+                result["db_commits"] = batch.commits;
+                result["db_jobs"] = batch.jobs;
+                result["db_last_batch_size"] = batch.lastBatchSize;
+                result["db_max_batch_size"] = batch.maxBatchSize;
+                result["db_avg_batch_size"] = batch.commits ? static_cast<double>(batch.jobs) / batch.commits : 0.0;
+                result["db_last_commit_ms"] = batch.lastCommitMs;
+                result["db_max_commit_ms"] = batch.maxCommitMs;
+                result["db_avg_commit_ms"] = batch.commits ? batch.totalCommitMs / batch.commits : 0.0;
+                
+                if (req.url_params.get("verify")) {
+                    auto db = manager->getDbManager();
+                    db->flush();
+                    int dbTotal = db->getTaskCount();
+                    int dbPending = db->getPendingTaskCount();
+                    int dbRunning = db->getRunningTaskCount();
+                    int dbCompleted = db->getCompletedTaskCount();
+                    int dbNodes = db->getNodeCount();
+                    result["verify"]["total_tasks"] = dbTotal;
+                    result["verify"]["pending_tasks"] = dbPending;
+                    result["verify"]["running_tasks"] = dbRunning;
+                    result["verify"]["completed_tasks"] = dbCompleted;
+                    result["verify"]["total_nodes"] = dbNodes;
+                    // Tasks changing status while this runs can make a single check differ
+                    result["verify"]["consistent"] =
+                        dbTotal == manager->getTotalTaskCount() &&
+                        dbPending == manager->getPendingTaskCount() &&
+                        dbRunning == manager->getRunningTaskCount() &&
+                        dbCompleted == manager->getCompletedTaskCount() &&
+                        dbNodes == manager->getTotalNodeCount();
+                }
+                
                 // Set the response
                 res = crow::response(result);
                 res.code = 200;
@@ -360,6 +837,216 @@ int main() {
             }
         });
 
+    // Prometheus scrape target: task, node, scheduler, database and HTTP metrics
+    CROW_ROUTE(app, "/metrics").methods("GET"_method)(
+        [manager, &app](const crow::request&, crow::response& res) {
+            MetricsWriter metrics;
+            manager->writeMetrics(metrics);
+            app.get_middleware<HttpMetrics>().writeMetrics(metrics);
+            
+            res.code = 200;
+            res.set_header("Content-Type", "text/plain; version=0.0.4");
+            res.write(metrics.str());
+            add_cors_headers(res);
+            res.end();
+        });
+
+    // Depth of the pending-task ready queue (tasks waiting for a free node)
+    CROW_ROUTE(app, "/backlog").methods("GET"_method)(
+        [manager](const crow::request&, crow::response& res) {
+            try {
+                crow::json::wvalue result;
+                result["depth"] = manager->getBacklogDepth();
+                result["scheduled"] = manager->getScheduledTaskCount();
+                
+                res = crow::response(result);
+                res.code = 200;
+                add_cors_headers(res);
+                res.end();
+            } catch (const std::exception& e) {
+                res.code = 500;
+                res.write(std::string("Error getting backlog: ") + e.what());
+                add_cors_headers(res);
+                res.end();
+            }
+        });
+
+    // Lifecycle of one task: when it was submitted, assigned to a node,
+    // started and finished (Unix microseconds, null until it happens), and
+    // the time spent in each stage once both ends are known
+    CROW_ROUTE(app, "/tasks/<int>/timeline").methods("GET"_method)(
+        [manager](const crow::request&, crow::response& res, int taskId) {
+            auto task = manager->getTask(taskId);
+            if (!task) {
+                res.code = 404;
+                res.write("Task not found");
+                add_cors_headers(res);
+                res.end();
+                return;
+            }
+            TaskTimeline timeline = task->getTimeline();
+            auto stamp = [](long long micros) {
+                return micros ? crow::json::wvalue(static_cast<int64_t>(micros)) : crow::json::wvalue(nullptr);
+            };
+            auto stage = [](long long from, long long to) {
+                return from && to ? crow::json::wvalue(static_cast<int64_t>(std::max(0LL, to - from))) : crow::json::wvalue(nullptr);
+            };
+            long long ready = std::max(timeline.submitted, task->getRunAt() * 1000);
+
+            crow::json::wvalue result;
+            result["id"] = task->getId();
+            result["status"] = static_cast<int>(task->getStatus());
+            if (timeline.assigned) {
+                result["scheduler"] = TaskManager::schedulerName(
+                    static_cast<SchedulerType>(task->getSchedulerTag()));
+            } else {
+                result["scheduler"] = nullptr;
+            }
+            result["submitted_us"] = stamp(timeline.submitted);
+            result["assigned_us"] = stamp(timeline.assigned);
+            result["started_us"] = stamp(timeline.started);
+            result["finished_us"] = stamp(timeline.finished);
+            result["backlog_us"] = stage(ready, timeline.assigned);
+            result["node_queue_us"] = stage(timeline.assigned, timeline.started);
+            result["execution_us"] = stage(timeline.started, timeline.finished);
+            result["end_to_end_us"] = stage(timeline.submitted, timeline.finished);
+
+            res = crow::response(result);
+            res.code = 200;
+            add_cors_headers(res);
+            res.end();
+        });
+
+    // Stage latency percentiles (microseconds) of finished tasks, per
+    // scheduler that placed them; schedulers with no finished tasks are left out
+    CROW_ROUTE(app, "/task_latency").methods("GET"_method)(
+        [manager](const crow::request&, crow::response& res) {
+            auto percentiles = [](const HistogramSnapshot& snapshot) {
+                crow::json::wvalue item;
+                item["p50"] = snapshot.percentile(0.5) / 1000;
+                item["p90"] = snapshot.percentile(0.9) / 1000;
+                item["p99"] = snapshot.percentile(0.99) / 1000;
+                item["p999"] = snapshot.percentile(0.999) / 1000;
+                return item;
+            };
+
+            crow::json::wvalue result = crow::json::wvalue::object();
+            for (size_t type = 0; type < kSchedulerTypeCount; ++type) {
+                auto schedulerType = static_cast<SchedulerType>(type);
+                TaskManager::StageLatencies latencies = manager->getStageLatencies(schedulerType);
+                if (latencies.endToEnd.count == 0) {
+                    continue;
+                }
+                crow::json::wvalue& item = result[TaskManager::schedulerName(schedulerType)];
+                item["tasks"] = latencies.endToEnd.count;
+                item["backlog"] = percentiles(latencies.backlog);
+                item["node_queue"] = percentiles(latencies.nodeQueue);
+                item["execution"] = percentiles(latencies.execution);
+                item["end_to_end"] = percentiles(latencies.endToEnd);
+            }
+
+            res = crow::response(result);
+            res.code = 200;
+            add_cors_headers(res);
+            res.end();
+        });
+
+    // Delta feed: /changes?since=<version>&limit=<n> returns the mutations
+    // after `since` and the version to poll from next. When `since` has fallen
+    // out of the change log window, "resync" is true: refetch /tasks and
+    // /nodes, then continue from the returned version.
+    CROW_ROUTE(app, "/changes").methods("GET"_method)(
+        [manager](const crow::request& req, crow::response& res) {
+            try {
+                const long long defaultLimit = 500;
+                const long long maxLimit = 5000;
+                long long since = 0;
+                long long requestedLimit = defaultLimit;
+                std::string error = parseIntParam(req, "since", INT64_MIN, INT64_MAX, since);
+                if (error.empty()) {
+                    error = parseIntParam(req, "limit", 1, INT32_MAX, requestedLimit);
+                }
+                if (!error.empty()) {
+                    res.code = 400;
+                    res.write(error);
+                    add_cors_headers(res);
+                    res.end();
+                    return;
+                }
+                size_t limit = static_cast<size_t>(std::min(requestedLimit, maxLimit));
+
+                ChangeLog& changeLog = manager->getChangeLog();
+                // Read the version first: after a resync the client polls from
+                // here, and anything newer is still in the log
+                long long version = changeLog.getVersion();
+                std::vector<ChangeRecord> records;
+                bool inWindow = changeLog.getSince(since, limit, records);
+
+                crow::json::wvalue result;
+                std::vector<crow::json::wvalue> changes;
+                if (!inWindow) {
+                    result["resync"] = true;
+                    result["version"] = version;
+                } else {
+                    result["resync"] = false;
+                    for (const auto& record : records) {
+                        crow::json::wvalue change;
+                        change["version"] = record.version;
+                        change["type"] = ChangeLog::typeName(record.type);
+                        if (record.taskId != -1) {
+                            change["task_id"] = record.taskId;
+                            change["status"] = static_cast<int>(record.status);
+                            // Include the task itself so clients can render it without a fetch
+                            if (auto task = manager->getTask(record.taskId)) {
+                                change["task"]["id"] = task->getId();
+                                change["task"]["name"] = task->getName();
+                                change["task"]["duration"] = task->getDuration();
+                                change["task"]["status"] = static_cast<int>(task->getStatus());
+                            }
+                        }
+                        if (record.nodeId != -1) {
+                            change["node_id"] = record.nodeId;
+                        }
+                        changes.push_back(std::move(change));
+                    }
+                    // With a full page there may be more; poll again from the last record
+                    bool more = !records.empty() && records.size() == limit && records.back().version < changeLog.getVersion();
+                    result["more"] = more;
+                    result["version"] = records.empty() ? since : records.back().version;
+                }
+                result["changes"] = std::move(changes);
+
+                res = crow::response(result);
+                res.code = 200;
+                add_cors_headers(res);
+                res.end();
+            } catch (const std::exception& e) {
+                res.code = 500;
+                res.write(std::string("Error getting changes: ") + e.what());
+                add_cors_headers(res);
+                res.end();
+            }
+        });
+
+    // Push channel: see EventBroadcaster for the frame format. Clients must
+    // send a message (e.g. "ack") after handling each frame to receive the next.
+    CROW_WEBSOCKET_ROUTE(app, "/ws")
+        .onopen([&broadcaster](crow::websocket::connection& conn) {
+            int clientId = broadcaster.subscribe([&conn](const std::string& frame) {
+                conn.send_text(frame);
+            });
+            conn.userdata(reinterpret_cast<void*>(static_cast<intptr_t>(clientId)));
+        })
+        .onmessage([&broadcaster](crow::websocket::connection& conn, const std::string&, bool) {
+            broadcaster.acknowledge(static_cast<int>(reinterpret_cast<intptr_t>(conn.userdata())));
+        })
+        .onclose([&broadcaster](crow::websocket::connection& conn, const std::string&, uint16_t) {
+            broadcaster.unsubscribe(static_cast<int>(reinterpret_cast<intptr_t>(conn.userdata())));
+        })
+        .onerror([&broadcaster](crow::websocket::connection& conn, const std::string&) {
+            broadcaster.unsubscribe(static_cast<int>(reinterpret_cast<intptr_t>(conn.userdata())));
+        });
+
     // Add health check endpoint
     CROW_ROUTE(app, "/health").methods("GET"_method)(
         [](const crow::request&, crow::response& res) {
@@ -375,7 +1062,11 @@ int main() {
     app.port(18080).multithreaded().run();
     
     std::cout << "Crow server stopped" << std::endl;
+    broadcaster.stop();
     std::cout << "Cleaning up resources..." << std::endl;
+    // The logger is never destroyed: write out what is still queued, and
+    // log anything from the teardown below directly
+    LoggingService::getInstance()->setAsync(false);
     
     // Allow time for cleanup before exiting
     std::this_thread::sleep_for(std::chrono::milliseconds(500));
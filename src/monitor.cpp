@@ -9,7 +9,7 @@ Monitor::Monitor(int id, const std::string& name)
 void Monitor::update(const std::string& message) {
     std::string logMessage = "Monitor '" + name + "' received: " + message;
     logs.push_back(logMessage);
-    LoggingService::getInstance()->debug(logMessage);
+    LOG_DEBUG(logMessage);
 }
 
 void Monitor::checkNodeStatus(const WorkerNode& node) {
@@ -17,7 +17,7 @@ void Monitor::checkNodeStatus(const WorkerNode& node) {
     std::string message = "Node '" + node.getName() + "' is " + status + 
                          " with " + std::to_string(node.getQueueSize()) + " tasks in queue";
     logs.push_back(message);
-    LoggingService::getInstance()->info(message);
+    LOG_INFO(message);
 }
 
 std::vector<std::string> Monitor::getLogs() const {
@@ -26,7 +26,7 @@ std::vector<std::string> Monitor::getLogs() const {
 
 void Monitor::clearLogs() {
     logs.clear();
-    LoggingService::getInstance()->debug("Monitor '" + name + "' logs cleared");
+    LOG_DEBUG("Monitor '", name, "' logs cleared");
 }
 
 int Monitor::getId() const {
@@ -23,8 +23,7 @@ Scheduler::~Scheduler() {
 
 void Scheduler::scheduleTask(time_t executionTime, SchedulerCommand* command) {
     scheduledTasks.push(std::make_pair(executionTime, command));
-    LoggingService::getInstance()->debug("Task scheduled for " + 
-                                       std::to_string(executionTime));
+    LOG_DEBUG("Task scheduled for ", executionTime);
 }
 
 void Scheduler::processScheduledTasks() {
@@ -53,7 +52,7 @@ void Scheduler::processScheduledTasks() {
 void Scheduler::start() {
     if (!running) {
         running = true;
-        LoggingService::getInstance()->info("Scheduler started");
+        LOG_INFO("Scheduler started");
         
         // In a real system, this would start a thread to process tasks
         // For simplicity, we'll just set the flag here
@@ -63,7 +62,7 @@ void Scheduler::start() {
 void Scheduler::stop() {
     if (running) {
         running = false;
-        LoggingService::getInstance()->info("Scheduler stopped");
+        LOG_INFO("Scheduler stopped");
     }
 }
 
@@ -81,5 +80,5 @@ void Scheduler::clearAllTasks() {
         delete scheduledTasks.top().second;
         scheduledTasks.pop();
     }
-    LoggingService::getInstance()->info("All scheduled tasks cleared");
+    LOG_INFO("All scheduled tasks cleared");
 }
\ No newline at end of file
@@ -1,23 +1,203 @@
 #include "../include/Task.h"
+#include "../include/TaskExecutor.h"
+#include "../include/SlabPool.h"
+#include <condition_variable>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+
+namespace {
+
+// Task names repeat heavily (bulk submissions share one), so each distinct
+// name is stored once. The set is split by hash so that threads creating
+// tasks rarely share a lock, and a name already there is found under a
+// shared lock. Entries are never removed; neither are tasks.
+struct alignas(64) NameShard {
+    std::shared_mutex mtx;
+    std::unordered_set<std::string> names;
+};
+const size_t kNameShards = 16;
+
+const std::string* internName(const std::string& name) {
+    static auto* shards = new NameShard[kNameShards];
+    NameShard& shard = shards[std::hash<std::string>()(name) % kNameShards];
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mtx);
+        auto it = shard.names.find(name);
+        if (it != shard.names.end()) {
+            return &*it;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(shard.mtx);
+    return &*shard.names.insert(name).first;
+}
+
+// Threads waiting in waitForYieldRequest() park on one of these, picked by
+// task id, instead of every task carrying its own mutex and condition variable
+struct alignas(64) YieldStripe {
+    std::mutex mtx;
+    std::condition_variable cv;
+};
+const size_t kYieldStripes = 64;
+
+YieldStripe& yieldStripe(int taskId) {
+    static YieldStripe stripes[kYieldStripes];
+    return stripes[static_cast<size_t>(taskId) % kYieldStripes];
+}
+
+}  // namespace
 
 Task::Task(int id, const std::string& name, int duration)
-    : id(id), name(name), duration(duration), status(TaskStatus::Pending) {}
+    : id(id), duration(duration), status(TaskStatus::Pending), priority(TaskPriority::Medium), failed(false),
+      yieldRequested(false), yielded(false), schedulerTag(0), inReadyQueue(false), preemptions(0), name(internName(name)),
+      observer(nullptr), runAt(0), checkpoint(0), submittedAt(clockMicros()), assignedAt(0), startedAt(0),
+      finishedAt(0) {}
 
 Task::Task(Task&& other) noexcept
-    : id(other.id), name(std::move(other.name)), duration(other.duration), status(other.status.load()) {}
+    : id(other.id), duration(other.duration), status(other.status.load()), priority(other.priority),
+      failed(other.failed.load()), yieldRequested(other.yieldRequested.load()), yielded(other.yielded),
+      schedulerTag(other.schedulerTag), inReadyQueue(other.inReadyQueue), preemptions(other.preemptions.load()), name(other.name),
+      observer(other.observer), executor(std::move(other.executor)), runAt(other.runAt),
+      checkpoint(other.checkpoint), submittedAt(other.submittedAt.load()), assignedAt(other.assignedAt.load()),
+      startedAt(other.startedAt.load()), finishedAt(other.finishedAt.load()) {}
 
 Task& Task::operator=(Task&& other) noexcept {
     if (this != &other) {
         id = other.id;
-        name = std::move(other.name);
+        name = other.name;
         duration = other.duration;
         status.store(other.status.load());
+        observer = other.observer;
+        executor = std::move(other.executor);
+        failed.store(other.failed.load());
+        runAt = other.runAt;
+        priority = other.priority;
+        yieldRequested.store(other.yieldRequested.load());
+        yielded = other.yielded;
+        checkpoint = other.checkpoint;
+        preemptions.store(other.preemptions.load());
+        schedulerTag = other.schedulerTag;
+        inReadyQueue = other.inReadyQueue;
+        setTimeline(other.getTimeline());
     }
     return *this;
 }
 
 int Task::getId() const { return id; }
-std::string Task::getName() const { return name; }
+std::string Task::getName() const { return *name; }
+const std::string& Task::getNameRef() const { return *name; }
 int Task::getDuration() const { return duration; }
 TaskStatus Task::getStatus() const { return status.load(); }
-void Task::setStatus(TaskStatus s) { status.store(s); }
+void Task::setStatus(TaskStatus s) {
+    if (s == TaskStatus::Running && startedAt.load(std::memory_order_relaxed) == 0) {
+        startedAt.store(clockMicros(), std::memory_order_relaxed);
+    } else if (s == TaskStatus::Completed) {
+        finishedAt.store(clockMicros(), std::memory_order_relaxed);
+    }
+    TaskStatus previous = status.exchange(s);
+    if (observer && previous != s) {
+        observer->onStatusChange(*this, previous, s);
+    }
+}
+bool Task::compareAndSetStatus(TaskStatus expected, TaskStatus s) {
+    if (!status.compare_exchange_strong(expected, s)) {
+        return false;
+    }
+    if (s == TaskStatus::Running && startedAt.load(std::memory_order_relaxed) == 0) {
+        startedAt.store(clockMicros(), std::memory_order_relaxed);
+    } else if (s == TaskStatus::Completed) {
+        finishedAt.store(clockMicros(), std::memory_order_relaxed);
+    }
+    if (observer && expected != s) {
+        observer->onStatusChange(*this, expected, s);
+    }
+    return true;
+}
+void Task::setObserver(TaskObserver* o) { observer = o; }
+
+void Task::setExecutor(std::shared_ptr<TaskExecutor> e) { executor = std::move(e); }
+std::shared_ptr<TaskExecutor> Task::getExecutor() const { return executor; }
+bool Task::hasFailed() const { return failed.load(); }
+void Task::markFailed() { failed = true; }
+void Task::setRunAt(long long r) { runAt = r; }
+long long Task::getRunAt() const { return runAt; }
+void Task::setPriority(TaskPriority p) { priority = p; }
+TaskPriority Task::getPriority() const { return priority; }
+void Task::setSchedulerTag(uint8_t tag) { schedulerTag = tag; }
+uint8_t Task::getSchedulerTag() const { return schedulerTag; }
+void Task::setInReadyQueue(bool queued) { inReadyQueue = queued; }
+bool Task::isInReadyQueue() const { return inReadyQueue; }
+
+TaskTimeline Task::getTimeline() const {
+    TaskTimeline timeline;
+    timeline.submitted = submittedAt.load(std::memory_order_relaxed);
+    timeline.assigned = assignedAt.load(std::memory_order_relaxed);
+    timeline.started = startedAt.load(std::memory_order_relaxed);
+    timeline.finished = finishedAt.load(std::memory_order_relaxed);
+    return timeline;
+}
+
+void Task::markAssigned() {
+    assignedAt.store(clockMicros(), std::memory_order_relaxed);
+}
+
+void Task::setTimeline(const TaskTimeline& timeline) {
+    submittedAt.store(timeline.submitted, std::memory_order_relaxed);
+    assignedAt.store(timeline.assigned, std::memory_order_relaxed);
+    startedAt.store(timeline.started, std::memory_order_relaxed);
+    finishedAt.store(timeline.finished, std::memory_order_relaxed);
+}
+
+long long Task::clockMicros() {
+    using namespace std::chrono;
+    static const long long offset =
+        duration_cast<microseconds>(system_clock::now().time_since_epoch()).count() -
+        duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count() + offset;
+}
+
+bool Task::execute() {
+    yielded = false;
+    bool ok = executor ? executor->execute(*this) : SleepExecutor().execute(*this);
+    if (yielded) {
+        preemptions++;
+    } else {
+        checkpoint = 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(yieldStripe(id).mtx);
+        yieldRequested = false;
+    }
+    failed = !ok;
+    return ok;
+}
+
+void Task::requestYield() {
+    YieldStripe& stripe = yieldStripe(id);
+    {
+        std::lock_guard<std::mutex> lock(stripe.mtx);
+        yieldRequested = true;
+    }
+    stripe.cv.notify_all();
+}
+
+bool Task::isYieldRequested() const { return yieldRequested.load(std::memory_order_relaxed); }
+
+bool Task::waitForYieldRequest(std::chrono::milliseconds timeout) const {
+    YieldStripe& stripe = yieldStripe(id);
+    std::unique_lock<std::mutex> lock(stripe.mtx);
+    return stripe.cv.wait_for(lock, timeout, [this] { return yieldRequested.load(); });
+}
+
+void Task::yieldAt(long long c) {
+    checkpoint = c;
+    yielded = true;
+}
+
+long long Task::getCheckpoint() const { return checkpoint; }
+bool Task::hasYielded() const { return yielded; }
+int Task::getPreemptionCount() const { return preemptions.load(); }
+
+std::shared_ptr<Task> makeTask(int id, const std::string& name, int duration) {
+    return std::allocate_shared<Task>(PoolAllocator<Task>(), id, name, duration);
+}
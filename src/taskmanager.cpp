@@ -4,20 +4,51 @@
 #include "../include/FIFOScheduler.h"
 #include "../include/RoundRobinScheduler.h"
 #include "../include/LoadBalancedScheduler.h"
+#include "../include/PowerOfTwoChoicesScheduler.h"
+#include "../include/LeastWorkScheduler.h"
 #include "../include/DatabaseManager.h"
+#include "../include/loggingservice.h"
 #include <sstream>
-#include <iostream>
 #include <algorithm>
+#include <chrono>
 
-TaskManager::TaskManager(std::unique_ptr<Scheduler> scheduler, const std::string& dbPath)
-    : scheduler(std::move(scheduler)), 
+namespace {
+
+long long unixMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace
+
+TaskManager::TaskManager(std::unique_ptr<Scheduler> scheduler, const std::string& dbPath,
+                         size_t taskShardCount)
+    : changeLog(kChangeLogCapacity),
+      taskShards(new TaskShard[std::max<size_t>(taskShardCount, 1)]),
+      taskShardCount(std::max<size_t>(taskShardCount, 1)),
+      scheduler(std::move(scheduler)), 
       currentSchedulerType(SchedulerType::FIFO),
       currentSchedulerName("FIFO"),
+      pickLatency(MetricsWriter::label("scheduler", "other")),
+      currentPickLatency(&pickLatency.get(MetricsWriter::label("scheduler", currentSchedulerName))),
       nextTaskId(1), 
       nextNodeId(1),
-      dbManager(std::make_shared<DatabaseManager>(dbPath)) {}
+      readyCanceled(0),
+      readyDepth(0),
+      dbManager(std::make_shared<DatabaseManager>(dbPath)),
+      workStealing(true),
+      defaultNodeSlots(1),
+      shortestJobFirst(false),
+      priorityAgingMs(TaskQueue::kDefaultAgingInterval.count()),
+      preemptionPolicy(PreemptionPolicy::Off),
+      preemptionBudget(kDefaultPreemptionBudget) {
+    this->scheduler->setLoadIndex(&loadIndex);
+}
 
 TaskManager::~TaskManager() {
+    // No more delayed tasks may be released once teardown starts
+    timers.stop();
+    
     // Stop all nodes when the manager is destroyed
     for (auto& node : nodes) {
         node->stop();
@@ -25,11 +56,11 @@ TaskManager::~TaskManager() {
 }
 
 bool TaskManager::initialize() {
-    std::cout << "Initializing TaskManager..." << std::endl;
+    LOG_INFO("Initializing TaskManager...");
     
     // Initialize the database
     if (!dbManager->initialize()) {
-        std::cerr << "Failed to initialize database." << std::endl;
+        LOG_ERROR("Failed to initialize database.");
         return false;
     }
     
@@ -38,120 +69,464 @@ bool TaskManager::initialize() {
     nextNodeId = dbManager->getMaxNodeId() + 1;
     
     // Load tasks from database
-    tasks = dbManager->loadAllTasks();
-    std::cout << "Loaded " << tasks.size() << " tasks from database." << std::endl;
+    auto loadedTasks = dbManager->loadAllTasks();
+    for (auto& task : loadedTasks) {
+        insertTask(task);
+    }
+    LOG_INFO("Loaded ", loadedTasks.size(), " tasks from database.");
+    
+    std::lock_guard<std::mutex> lock(mtx);
     
     // Load nodes from database
     nodes = dbManager->loadAllNodes(this);
-    std::cout << "Loaded " << nodes.size() << " nodes from database." << std::endl;
+    for (auto& node : nodes) {
+        nodeIndex[node->getId()] = node;
+        loadIndex.add(node->getId());
+    }
+    publishNodeSnapshotLocked();
+    LOG_INFO("Loaded ", nodes.size(), " nodes from database.");
     
     // Start all nodes
     for (auto& node : nodes) {
+        node->setShortestJobFirst(shortestJobFirst);
+        node->setPriorityAging(getPriorityAging());
+        node->setPreemption(preemptionPolicy, preemptionBudget);
         node->start();
     }
     
-    // Try to assign any pending tasks
-    for (auto& task : tasks) {
-        if (task->getStatus() == TaskStatus::Pending) {
-            int nodeIndex = scheduler->pickNode(nodes);
-            if (nodeIndex != -1) {
-                nodes[nodeIndex]->addTask(task);
-                dbManager->assignTaskToNode(task->getId(), nodes[nodeIndex]->getId());
-            }
+    // Try to assign any pending tasks; whatever can't be placed waits in the
+    // ready queue, and tasks whose run_at is still ahead go back on a timer
+    timers.start();
+    long long now = unixMillis();
+    for (auto& task : loadedTasks) {
+        if (task->getStatus() != TaskStatus::Pending) {
+            continue;
+        }
+        if (task->getRunAt() > now) {
+            armDelayedTask(task, now);
+        } else {
+            placeTaskLocked(task);
         }
     }
+    LOG_INFO("Ready queue holds ", readyQueue.size(), " pending tasks, ", timers.size(),
+             " scheduled for later.");
     
-    std::cout << "TaskManager initialized successfully." << std::endl;
+    LOG_INFO("TaskManager initialized successfully.");
     return true;
 }
 
-void TaskManager::addTask(const std::string& name, int duration) {
-    std::lock_guard<std::mutex> lock(mtx);
+TaskManager::TaskShard& TaskManager::shardFor(int taskId) const {
+    return taskShards[static_cast<size_t>(taskId) % taskShardCount];
+}
+
+void TaskManager::insertIntoShardLocked(TaskShard& shard, const std::shared_ptr<Task>& task) {
+    // Ids are handed out in increasing order, so this is almost always an append
+    auto position = std::upper_bound(shard.ids.begin(), shard.ids.end(), task->getId()) - shard.ids.begin();
+    shard.ids.insert(shard.ids.begin() + position, task->getId());
+    shard.statuses.insert(shard.statuses.begin() + position, task->getStatus());
+    shard.tasks.insert(shard.tasks.begin() + position, task);
+    if (task->getStatus() != TaskStatus::Completed) {
+        shard.activeIds[static_cast<size_t>(task->getStatus())].insert(task->getId());
+    }
+}
+
+long TaskManager::findInShardLocked(const TaskShard& shard, int taskId) const {
+    // Ids are handed out consecutively and dealt round-robin over the shards,
+    // so a shard's ids are normally dense: try where the id would be first
+    if (!shard.ids.empty() && taskId >= shard.ids.front()) {
+        size_t guess = static_cast<size_t>(taskId - shard.ids.front()) / taskShardCount;
+        if (guess < shard.ids.size() && shard.ids[guess] == taskId) {
+            return static_cast<long>(guess);
+        }
+    }
+    auto it = std::lower_bound(shard.ids.begin(), shard.ids.end(), taskId);
+    if (it == shard.ids.end() || *it != taskId) {
+        return -1;
+    }
+    return it - shard.ids.begin();
+}
+
+void TaskManager::insertTask(const std::shared_ptr<Task>& task) {
+    TaskShard& shard = shardFor(task->getId());
+    {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        insertIntoShardLocked(shard, task);
+    }
+    task->setObserver(this);
+    counters.onTaskAdded(task->getStatus());
+}
+
+void TaskManager::insertTasks(const std::vector<std::shared_ptr<Task>>& tasks) {
+    // Group by shard so each shard lock is taken once for the whole batch
+    std::vector<std::vector<const std::shared_ptr<Task>*>> byShard(taskShardCount);
+    for (const auto& task : tasks) {
+        byShard[static_cast<size_t>(task->getId()) % taskShardCount].push_back(&task);
+    }
+    for (size_t i = 0; i < taskShardCount; ++i) {
+        if (byShard[i].empty()) continue;
+        std::lock_guard<std::mutex> lock(taskShards[i].mtx);
+        for (const auto* task : byShard[i]) {
+            insertIntoShardLocked(taskShards[i], *task);
+        }
+    }
+    for (const auto& task : tasks) {
+        task->setObserver(this);
+        counters.onTaskAdded(task->getStatus());
+    }
+}
+
+void TaskManager::onStatusChange(const Task& task, TaskStatus from, TaskStatus to) {
+    counters.onStatusChange(task, from, to);
+    changeLog.append(ChangeType::TaskStatusChanged, task.getId(), -1, to);
+    if (to == TaskStatus::Completed) {
+        recordStageLatencies(task);
+    }
     
-    auto task = std::make_shared<Task>(nextTaskId++, name, duration);
-    tasks.push_back(task);
+    // Two transitions of the same task can reach this point in either order,
+    // so file the id under whatever its status is now rather than under `to`
+    TaskShard& shard = shardFor(task.getId());
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    long position = findInShardLocked(shard, task.getId());
+    if (position == -1) {
+        return;
+    }
+    TaskStatus current = task.getStatus();
+    shard.statuses[position] = current;
+    for (auto& ids : shard.activeIds) {
+        ids.erase(task.getId());
+    }
+    if (current != TaskStatus::Completed) {
+        shard.activeIds[static_cast<size_t>(current)].insert(task.getId());
+    }
+}
+
+int TaskManager::addTask(const std::string& name, int duration, std::shared_ptr<TaskExecutor> executor,
+                         long long runAt, TaskPriority priority) {
+    auto task = makeTask(nextTaskId++, name, duration);
+    task->setExecutor(std::move(executor));
+    task->setRunAt(runAt);
+    task->setPriority(priority);
+    insertTask(task);
+    changeLog.append(ChangeType::TaskCreated, task->getId(), -1);
     
-    // Save the task to the database
+    // Save the task to the database (queued, so it precedes the assignment below)
     dbManager->saveTask(task);
     
+    long long now = unixMillis();
+    if (runAt > now) {
+        armDelayedTask(task, now);
+        LOG_DEBUG("Scheduled task '", name, "' to run in ", runAt - now, " ms");
+        return task->getId();
+    }
+    
     // Try to assign the task to a node immediately
-    int nodeIndex = scheduler->pickNode(nodes);
+    std::lock_guard<std::mutex> lock(mtx);
+    int nodeId = placeTaskLocked(task);
+    if (nodeId != -1) {
+        LOG_DEBUG("Assigned task '", name, "' to Node ", nodeId);
+    } else {
+        LOG_DEBUG("No available nodes for task '", name, "' - task will remain pending");
+    }
+    return task->getId();
+}
+
+std::vector<int> TaskManager::addTasks(const std::vector<TaskSpec>& specs) {
+    std::vector<int> ids;
+    if (specs.empty()) {
+        return ids;
+    }
     
-    if (nodeIndex != -1) {
-        nodes[nodeIndex]->addTask(task);
-        
-        // Record the assignment in the database
-        dbManager->assignTaskToNode(task->getId(), nodes[nodeIndex]->getId());
-        
-        std::cout << "Assigned task '" << name << "' to Node " << nodes[nodeIndex]->getId() << std::endl;
+    // Reserve a contiguous block of ids
+    int firstId = nextTaskId.fetch_add(static_cast<int>(specs.size()));
+    long long now = unixMillis();
+    std::vector<std::shared_ptr<Task>> batch;
+    // Only filled when some task has a future runAt; the rest are placed now
+    std::vector<std::shared_ptr<Task>> delayed, placeable;
+    batch.reserve(specs.size());
+    ids.reserve(specs.size());
+    for (size_t i = 0; i < specs.size(); ++i) {
+        batch.push_back(makeTask(firstId + static_cast<int>(i), specs[i].name, specs[i].duration));
+        batch.back()->setExecutor(specs[i].executor);
+        batch.back()->setPriority(specs[i].priority);
+        batch.back()->setRunAt(specs[i].runAt);
+        ids.push_back(firstId + static_cast<int>(i));
+        if (specs[i].runAt > now) {
+            if (delayed.empty()) {
+                placeable.assign(batch.begin(), batch.end() - 1);
+            }
+            delayed.push_back(batch.back());
+        } else if (!delayed.empty()) {
+            placeable.push_back(batch.back());
+        }
+    }
+    insertTasks(batch);
+    for (const auto& task : batch) {
+        changeLog.append(ChangeType::TaskCreated, task->getId(), -1);
+    }
+    const auto& toPlace = delayed.empty() ? batch : placeable;
+    
+    std::lock_guard<std::mutex> lock(mtx);
+    
+    // One scheduler call for the whole batch
+    std::vector<int> picks;
+    if (!toPlace.empty()) {
+        picks = currentPickLatency->time([&] {
+            return scheduler->pickNodesForTasks(nodes, toPlace);
+        });
+    }
+    std::vector<int> nodeIds(batch.size(), -1);
+    std::vector<std::vector<std::shared_ptr<Task>>> perNode(nodes.size());
+    size_t waiting = 0;
+    for (size_t i = 0; i < toPlace.size(); ++i) {
+        toPlace[i]->setSchedulerTag(static_cast<uint8_t>(currentSchedulerType));
+        if (picks[i] == -1) {
+            parkTaskLocked(toPlace[i]);
+            waiting++;
+        } else {
+            // Ids are contiguous, so the id gives the task's place in the batch
+            nodeIds[toPlace[i]->getId() - firstId] = nodes[picks[i]]->getId();
+            perNode[picks[i]].push_back(toPlace[i]);
+        }
+    }
+    updateReadyDepthLocked();
+    if (waiting > 0) {
+        preemptForReadyQueueLocked();
+    }
+    
+    // Tasks and assignments go out as one database job (one transaction),
+    // queued before any node can start on them
+    dbManager->saveTasks(batch, nodeIds);
+    
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        nodes[n]->addTasks(perNode[n]);
+    }
+    // After the save, like addTask, so a release never precedes its row
+    for (const auto& task : delayed) {
+        armDelayedTask(task, now);
+    }
+    
+    LOG_DEBUG("Added ", batch.size(), " tasks (", toPlace.size() - waiting, " assigned, ", waiting,
+              " pending, ", delayed.size(), " scheduled)");
+    return ids;
+}
+
+int TaskManager::placeTaskLocked(const std::shared_ptr<Task>& task) {
+    task->setSchedulerTag(static_cast<uint8_t>(currentSchedulerType));
+    int nodeIndex = currentPickLatency->time([&] { return scheduler->pickNode(nodes); });
+    
+    if (nodeIndex == -1) {
+        parkTaskLocked(task);
+        updateReadyDepthLocked();
+        preemptForReadyQueueLocked();
+        return -1;
+    }
+    
+    nodes[nodeIndex]->addTask(task);
+    
+    // Record the assignment in the database
+    dbManager->assignTaskToNode(task->getId(), nodes[nodeIndex]->getId());
+    return nodes[nodeIndex]->getId();
+}
+
+bool TaskManager::dispatchPendingTask() {
+    // Called by every node after every task; most of the time there is nothing waiting
+    if (readyDepth.load() == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    return dispatchPendingTaskLocked();
+}
+
+bool TaskManager::dispatchPendingTaskLocked() {
+    if (readyQueue.empty()) {
+        return false;
+    }
+    
+    int nodeIndex = currentPickLatency->time([&] { return scheduler->pickNode(nodes); });
+    if (nodeIndex == -1) {
+        return false;
+    }
+    
+    // Anything that stopped being pending while it waited is dropped
+    std::shared_ptr<Task> task;
+    while ((task = readyQueue.pop())) {
+        // cancelTask clears the flag of the tasks it counted as canceled
+        bool counted = !task->isInReadyQueue();
+        task->setInReadyQueue(false);
+        if (task->getStatus() == TaskStatus::Pending) {
+            break;
+        }
+        if (counted) {
+            readyCanceled--;
+        }
+    }
+    updateReadyDepthLocked();
+    if (!task) {
+        return false;
+    }
+    nodes[nodeIndex]->addTask(task);
+    
+    // Record the assignment in the database
+    dbManager->assignTaskToNode(task->getId(), nodes[nodeIndex]->getId());
+    
+    LOG_DEBUG("Reassigned pending task '", task->getName(), "' to Node ", nodes[nodeIndex]->getId());
+    if (!readyQueue.empty()) {
+        preemptForReadyQueueLocked();
+    }
+    return true;
+}
+
+void TaskManager::parkTaskLocked(const std::shared_ptr<Task>& task) {
+    task->setInReadyQueue(true);
+    readyQueue.push(task);
+}
+
+void TaskManager::updateReadyDepthLocked() {
+    readyDepth = readyQueue.size() - readyCanceled;
+}
+
+void TaskManager::preemptForReadyQueueLocked() {
+    if (preemptionPolicy.load() == PreemptionPolicy::Off || readyDepth.load() == 0) {
+        return;
+    }
+    TaskPriority priority = readyQueue.topPriority();
+    for (auto& node : nodes) {
+        if (node->preemptFor(priority)) {
+            return;
+        }
+    }
+}
+
+size_t TaskManager::getBacklogDepth() const {
+    return readyDepth.load();
+}
+
+size_t TaskManager::getScheduledTaskCount() const {
+    return timers.size();
+}
+
+void TaskManager::armDelayedTask(const std::shared_ptr<Task>& task, long long now) {
+    int taskId = task->getId();
+    std::lock_guard<std::mutex> lock(delayedMtx);
+    delayedTasks[taskId] = timers.schedule(std::chrono::milliseconds(task->getRunAt() - now),
+        [this, taskId] { releaseDelayedTask(taskId); });
+}
+
+void TaskManager::releaseDelayedTask(int taskId) {
+    {
+        std::lock_guard<std::mutex> lock(delayedMtx);
+        delayedTasks.erase(taskId);
+    }
+    
+    auto task = getTask(taskId);
+    if (!task || task->getStatus() != TaskStatus::Pending) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(mtx);
+    int nodeId = placeTaskLocked(task);
+    if (nodeId != -1) {
+        LOG_DEBUG("Released scheduled task '", task->getName(), "' to Node ", nodeId);
     } else {
-        std::cout << "No available nodes for task '" << name << "' - task will remain pending\n";
+        LOG_DEBUG("Released scheduled task '", task->getName(),
+                  "' - no available nodes, task will remain pending");
     }
 }
 
-void TaskManager::addNode() {
+void TaskManager::setAllowCommands(bool allow) {
+    dbManager->setAllowCommands(allow);
+}
+
+void TaskManager::setWorkStealing(bool enabled) {
+    workStealing = enabled;
+    // Idle slots sleep without a timeout while stealing is off
+    if (enabled) {
+        if (auto nodes = getNodeSnapshot()) {
+            for (const auto& node : *nodes) {
+                node->wake();
+            }
+        }
+    }
+}
+
+bool TaskManager::isWorkStealingEnabled() const {
+    return workStealing.load();
+}
+
+std::shared_ptr<const std::vector<std::shared_ptr<Node>>> TaskManager::getNodeSnapshot() const {
+    return std::atomic_load(&nodeSnapshot);
+}
+
+void TaskManager::publishNodeSnapshotLocked() {
+    std::atomic_store(&nodeSnapshot,
+        std::shared_ptr<const std::vector<std::shared_ptr<Node>>>(
+            std::make_shared<std::vector<std::shared_ptr<Node>>>(nodes)));
+}
+
+void TaskManager::setDefaultNodeSlots(size_t slots) {
+    defaultNodeSlots = slots > 0 ? slots : 1;
+}
+
+int TaskManager::addNode(size_t slots) {
     std::lock_guard<std::mutex> lock(mtx);
-    auto node = std::make_shared<Node>(nextNodeId++, this); 
+    auto node = std::make_shared<Node>(nextNodeId++, this, slots > 0 ? slots : defaultNodeSlots.load()); 
+    loadIndex.add(node->getId());
+    node->setShortestJobFirst(shortestJobFirst);
+    node->setPriorityAging(getPriorityAging());
+    node->setPreemption(preemptionPolicy, preemptionBudget);
     node->start();
     nodes.push_back(node);
+    nodeIndex[node->getId()] = node;
+    publishNodeSnapshotLocked();
+    changeLog.append(ChangeType::NodeAdded, -1, node->getId());
     
     // Save the node to the database
     dbManager->saveNode(node);
     
-    // After adding a new node, check if there are any pending tasks that can be assigned
-    for (auto& task : tasks) {
-        if (task->getStatus() == TaskStatus::Pending) {
-            // Use the scheduler to pick a node
-            int nodeIndex = scheduler->pickNode(nodes);
-            if (nodeIndex != -1) {
-                nodes[nodeIndex]->addTask(task);
-                
-                // Record the assignment in the database
-                dbManager->assignTaskToNode(task->getId(), nodes[nodeIndex]->getId());
-                
-                std::cout << "Reassigned pending task '" << task->getName() 
-                          << "' to Node " << nodes[nodeIndex]->getId() << std::endl;
-                break; // Assign one task at a time to avoid overloading the new node
-            }
-        }
+    // After adding a new node, hand out waiting work: one task per executor
+    // slot to avoid overloading the new node; it pulls more as it completes them.
+    for (size_t i = 0; i < node->getSlotCount() && dispatchPendingTaskLocked(); ++i) {
     }
+    return node->getId();
 }
 
 void TaskManager::removeNode(int id) {
+    std::shared_ptr<Node> node;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        int position = findNodePosition(id);
+        if (position == -1) {
+            return;
+        }
+        
+        // Unlist the node so the scheduler stops picking it
+        node = nodes[position];
+        nodes.erase(nodes.begin() + position);
+        nodeIndex.erase(id);
+        loadIndex.remove(id);
+        publishNodeSnapshotLocked();
+        changeLog.append(ChangeType::NodeRemoved, -1, id);
+        
+        // Remove from database
+        dbManager->deleteNode(id);
+    }
+    
+    // Stop the node outside the lock: joining its worker waits for the
+    // current task, and the worker itself calls back into dispatchPendingTask().
+    // Once it has stopped, take back whatever was still queued on it.
+    node->stop();
+    auto nodeTasks = node->drainQueue();
+    
+    // Reassign pending tasks to other nodes
     std::lock_guard<std::mutex> lock(mtx);
-    for (auto it = nodes.begin(); it != nodes.end(); ++it) {
-        if ((*it)->getId() == id) {
-            // Get any pending tasks from this node before stopping it
-            auto nodeTasks = (*it)->getTaskQueueSnapshot();
-            
-            // Stop the node
-            (*it)->stop();
-            
-            // Remove from database
-            dbManager->deleteNode(id);
-            
-            nodes.erase(it);
-            
-            // Reassign pending tasks to other nodes
-            for (auto& task : nodeTasks) {
-                if (task->getStatus() == TaskStatus::Pending) {
-                    int nodeIndex = scheduler->pickNode(nodes);
-                    if (nodeIndex != -1) {
-                        nodes[nodeIndex]->addTask(task);
-                        
-                        // Update assignment in database
-                        dbManager->assignTaskToNode(task->getId(), nodes[nodeIndex]->getId());
-                        
-                        std::cout << "Reassigned task from removed node '" << task->getName() 
-                                  << "' to Node " << nodes[nodeIndex]->getId() << std::endl;
-                    } else {
-                        std::cout << "No available nodes for reassigning task '" 
-                                  << task->getName() << "'\n";
-                    }
-                }
+    for (auto& task : nodeTasks) {
+        if (task->getStatus() == TaskStatus::Pending) {
+            int nodeId = placeTaskLocked(task);
+            if (nodeId != -1) {
+                LOG_DEBUG("Reassigned task from removed node '", task->getName(), "' to Node ", nodeId);
+            } else {
+                LOG_DEBUG("No available nodes for reassigning task '", task->getName(), "'");
             }
-            
-            break;
         }
     }
 }
@@ -160,28 +535,38 @@ void TaskManager::setScheduler(SchedulerType type) {
     try {
         std::lock_guard<std::mutex> lock(mtx);
         
-        std::cout << "Changing scheduler to type: " << static_cast<int>(type) << std::endl;
+        LOG_DEBUG("Changing scheduler to type: ", static_cast<int>(type));
         
         // Create the new scheduler
         std::unique_ptr<Scheduler> newScheduler;
         switch (type) {
             case SchedulerType::FIFO:
-                std::cout << "Creating FIFO scheduler" << std::endl;
+                LOG_DEBUG("Creating FIFO scheduler");
                 newScheduler = std::make_unique<FIFOScheduler>();
                 currentSchedulerName = "FIFO";
                 break;
             case SchedulerType::RoundRobin:
-                std::cout << "Creating RoundRobin scheduler" << std::endl;
+                LOG_DEBUG("Creating RoundRobin scheduler");
                 newScheduler = std::make_unique<RoundRobinScheduler>();
                 currentSchedulerName = "RoundRobin";
                 break;
             case SchedulerType::LoadBalanced:
-                std::cout << "Creating LoadBalanced scheduler" << std::endl;
+                LOG_DEBUG("Creating LoadBalanced scheduler");
                 newScheduler = std::make_unique<LoadBalancedScheduler>();
                 currentSchedulerName = "LoadBalanced";
                 break;
+            case SchedulerType::PowerOfTwoChoices:
+                LOG_DEBUG("Creating PowerOfTwoChoices scheduler");
+                newScheduler = std::make_unique<PowerOfTwoChoicesScheduler>();
+                currentSchedulerName = "PowerOfTwoChoices";
+                break;
+            case SchedulerType::LeastWork:
+                LOG_DEBUG("Creating LeastWork scheduler");
+                newScheduler = std::make_unique<LeastWorkScheduler>();
+                currentSchedulerName = "LeastWork";
+                break;
             default:
-                std::cout << "Unknown scheduler type, defaulting to FIFO" << std::endl;
+                LOG_WARNING("Unknown scheduler type, defaulting to FIFO");
                 newScheduler = std::make_unique<FIFOScheduler>();
                 currentSchedulerName = "FIFO";
                 type = SchedulerType::FIFO;
@@ -189,18 +574,20 @@ void TaskManager::setScheduler(SchedulerType type) {
         }
 
         // Now assign the new scheduler
+        newScheduler->setLoadIndex(&loadIndex);
         scheduler = std::move(newScheduler);
         currentSchedulerType = type;
-        std::cout << "Scheduler successfully changed to " << getCurrentSchedulerName() << std::endl;
+        currentPickLatency = &pickLatency.get(MetricsWriter::label("scheduler", currentSchedulerName));
+        LOG_INFO("Scheduler successfully changed to ", currentSchedulerName);
     } 
     catch (const std::exception& e) {
-        std::cerr << "Exception in setScheduler: " << e.what() << std::endl;
+        LOG_ERROR("Exception in setScheduler: ", e.what());
         // Fallback to FIFO scheduler in case of error
         scheduler = std::make_unique<FIFOScheduler>();
         currentSchedulerType = SchedulerType::FIFO;
     } 
     catch (...) {
-        std::cerr << "Unknown exception in setScheduler" << std::endl;
+        LOG_ERROR("Unknown exception in setScheduler");
         // Fallback to FIFO scheduler in case of error
         scheduler = std::make_unique<FIFOScheduler>();
         currentSchedulerType = SchedulerType::FIFO;
@@ -213,14 +600,57 @@ SchedulerType TaskManager::getCurrentSchedulerType() const {
 }
 
 std::string TaskManager::getCurrentSchedulerName() const {
+    std::lock_guard<std::mutex> lock(mtx);
     return currentSchedulerName;
 }
 
-std::vector<std::string> TaskManager::getAllNodesInfo() const {
+void TaskManager::setShortestJobFirst(bool enabled) {
+    std::lock_guard<std::mutex> lock(mtx);
+    shortestJobFirst = enabled;
+    for (auto& node : nodes) {
+        node->setShortestJobFirst(enabled);
+    }
+}
+
+bool TaskManager::isShortestJobFirst() const {
+    return shortestJobFirst.load();
+}
+
+void TaskManager::setPriorityAging(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(mtx);
+    priorityAgingMs = interval.count();
+    readyQueue.setAgingInterval(interval);
+    for (auto& node : nodes) {
+        node->setPriorityAging(interval);
+    }
+}
+
+std::chrono::milliseconds TaskManager::getPriorityAging() const {
+    return std::chrono::milliseconds(priorityAgingMs.load());
+}
+
+void TaskManager::setPreemption(PreemptionPolicy policy, int budget) {
     std::lock_guard<std::mutex> lock(mtx);
+    preemptionPolicy = policy;
+    preemptionBudget = budget > 0 ? budget : 0;
+    for (auto& node : nodes) {
+        node->setPreemption(policy, preemptionBudget);
+    }
+}
+
+PreemptionPolicy TaskManager::getPreemptionPolicy() const {
+    return preemptionPolicy.load();
+}
+
+int TaskManager::getPreemptionBudget() const {
+    return preemptionBudget.load();
+}
+
+std::vector<std::string> TaskManager::getAllNodesInfo() const {
+    auto snapshot = getNodeSnapshot();
     std::vector<std::string> result;
 
-    for (const auto& node : nodes) {
+    for (const auto& node : *snapshot) {
         std::ostringstream os;
         os << "Node-" << node->getId() << " | Tasks: " << node->getTaskCount();
         result.push_back(os.str());
@@ -230,64 +660,185 @@ std::vector<std::string> TaskManager::getAllNodesInfo() const {
 }
 
 std::vector<std::shared_ptr<Task>> TaskManager::getAllTasks() const {
-    std::lock_guard<std::mutex> lock(mtx);
-    return tasks;
+    // Copy one shard at a time so writers to other shards are never blocked
+    std::vector<std::shared_ptr<Task>> result;
+    for (size_t i = 0; i < taskShardCount; ++i) {
+        std::lock_guard<std::mutex> lock(taskShards[i].mtx);
+        result.insert(result.end(), taskShards[i].tasks.begin(), taskShards[i].tasks.end());
+    }
+    std::sort(result.begin(), result.end(),
+        [](const std::shared_ptr<Task>& a, const std::shared_ptr<Task>& b) { return a->getId() < b->getId(); });
+    return result;
+}
+
+TaskPage TaskManager::getTasksPage(int afterId, size_t limit, std::optional<TaskStatus> status) const {
+    // The first `limit` matches overall are among the first `limit` matches
+    // of each shard; take one extra to learn whether another page follows.
+    // Only ids and positions are collected here, from the shard arrays.
+    struct Matches {
+        std::vector<int> ids;
+        std::vector<size_t> positions;
+    };
+    std::vector<Matches> matches(taskShardCount);
+    for (size_t i = 0; i < taskShardCount; ++i) {
+        const TaskShard& shard = taskShards[i];
+        Matches& found = matches[i];
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        if (status && *status != TaskStatus::Completed) {
+            const auto& ids = shard.activeIds[static_cast<size_t>(*status)];
+            for (auto it = ids.upper_bound(afterId); it != ids.end() && found.ids.size() <= limit; ++it) {
+                found.ids.push_back(*it);
+                found.positions.push_back(static_cast<size_t>(findInShardLocked(shard, *it)));
+            }
+            continue;
+        }
+        size_t position = std::upper_bound(shard.ids.begin(), shard.ids.end(), afterId) - shard.ids.begin();
+        for (; position < shard.ids.size() && found.ids.size() <= limit; ++position) {
+            if (!status || shard.statuses[position] == *status) {
+                found.ids.push_back(shard.ids[position]);
+                found.positions.push_back(position);
+            }
+        }
+    }
+    
+    // Merge by id, recording which output slots each shard fills
+    TaskPage page;
+    std::vector<size_t> heads(taskShardCount, 0);
+    std::vector<std::vector<size_t>> slots(taskShardCount);
+    size_t filled = 0;
+    int lastId = afterId;
+    while (true) {
+        size_t best = taskShardCount;
+        for (size_t i = 0; i < taskShardCount; ++i) {
+            if (heads[i] < matches[i].ids.size() &&
+                (best == taskShardCount || matches[i].ids[heads[i]] < matches[best].ids[heads[best]])) {
+                best = i;
+            }
+        }
+        if (best == taskShardCount) {
+            break;
+        }
+        if (filled == limit) {
+            page.nextAfterId = lastId;
+            break;
+        }
+        lastId = matches[best].ids[heads[best]];
+        slots[best].push_back(filled++);
+        heads[best]++;
+    }
+    
+    // Then copy just the chosen tasks. A task inserted out of order since
+    // the first pass may have shifted a position; look those up again.
+    page.tasks.resize(filled);
+    for (size_t i = 0; i < taskShardCount; ++i) {
+        if (slots[i].empty()) continue;
+        const TaskShard& shard = taskShards[i];
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        for (size_t j = 0; j < slots[i].size(); ++j) {
+            size_t position = matches[i].positions[j];
+            if (position >= shard.ids.size() || shard.ids[position] != matches[i].ids[j]) {
+                position = static_cast<size_t>(findInShardLocked(shard, matches[i].ids[j]));
+            }
+            page.tasks[slots[i][j]] = shard.tasks[position];
+        }
+    }
+    return page;
 }
 
 std::vector<std::shared_ptr<Node>> TaskManager::getAllNodes() const {
+    return *getNodeSnapshot();
+}
+
+std::shared_ptr<Task> TaskManager::getTask(int taskId) const {
+    TaskShard& shard = shardFor(taskId);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    long position = findInShardLocked(shard, taskId);
+    return position != -1 ? shard.tasks[position] : nullptr;
+}
+
+std::shared_ptr<Node> TaskManager::getNode(int nodeId) const {
     std::lock_guard<std::mutex> lock(mtx);
-    return nodes;
+    auto it = nodeIndex.find(nodeId);
+    return it != nodeIndex.end() ? it->second : nullptr;
+}
+
+int TaskManager::findNodePosition(int nodeId) const {
+    // Node ids are handed out in increasing order and erasing keeps the
+    // order, so `nodes` can be binary searched
+    auto it = std::lower_bound(nodes.begin(), nodes.end(), nodeId,
+        [](const std::shared_ptr<Node>& node, int id) { return node->getId() < id; });
+    if (it == nodes.end() || (*it)->getId() != nodeId) {
+        return -1;
+    }
+    return static_cast<int>(it - nodes.begin());
 }
 
 bool TaskManager::assignTaskToNode(int taskId, int nodeId) {
-    std::lock_guard<std::mutex> lock(mtx);
-    
     // Find the task
-    auto taskIt = std::find_if(tasks.begin(), tasks.end(), 
-        [taskId](const auto& task) { return task->getId() == taskId; });
+    auto task = getTask(taskId);
         
-    if (taskIt == tasks.end() || (*taskIt)->getStatus() != TaskStatus::Pending) {
+    if (!task || task->getStatus() != TaskStatus::Pending) {
         return false; // Task not found or not pending
     }
     
+    std::lock_guard<std::mutex> lock(mtx);
+    
     // Find the node
-    auto nodeIt = std::find_if(nodes.begin(), nodes.end(),
-        [nodeId](const auto& node) { return node->getId() == nodeId; });
+    auto nodeIt = nodeIndex.find(nodeId);
         
-    if (nodeIt == nodes.end() || (*nodeIt)->isBusy()) {
+    if (nodeIt == nodeIndex.end() || nodeIt->second->isBusy()) {
         return false; // Node not found or busy
     }
     
     // Assign the task
-    (*nodeIt)->addTask(*taskIt);
+    nodeIt->second->addTask(task);
     
     // Update the assignment in the database
     dbManager->assignTaskToNode(taskId, nodeId);
     
-    std::cout << "Manually assigned task '" << (*taskIt)->getName() 
-              << "' to Node " << nodeId << std::endl;
+    LOG_DEBUG("Manually assigned task '", task->getName(), "' to Node ", nodeId);
     
     return true;
 }
 
 bool TaskManager::cancelTask(int taskId) {
-    std::lock_guard<std::mutex> lock(mtx);
-    
     // Find the task
-    auto taskIt = std::find_if(tasks.begin(), tasks.end(), 
-        [taskId](const auto& task) { return task->getId() == taskId; });
+    auto task = getTask(taskId);
         
-    if (taskIt == tasks.end() || (*taskIt)->getStatus() == TaskStatus::Completed) {
+    if (!task || task->getStatus() == TaskStatus::Completed) {
         return false; // Task not found or already completed
     }
     
-    // Mark it as completed
-    (*taskIt)->setStatus(TaskStatus::Completed);
+    // Mark it as completed; a running task with a preemptible executor
+    // stops at its next yield point
+    task->setStatus(TaskStatus::Completed);
+    task->requestYield();
+    
+    // Disarm its timer if it was waiting for its run_at time
+    {
+        std::lock_guard<std::mutex> lock(delayedMtx);
+        auto it = delayedTasks.find(taskId);
+        if (it != delayedTasks.end()) {
+            timers.cancel(it->second);
+            delayedTasks.erase(it);
+        }
+    }
+    
+    // Stop counting it in the backlog if it was still waiting for a node.
+    // The entry itself is dropped when dispatch reaches it.
+    if (readyDepth.load() > 0) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (task->isInReadyQueue()) {
+            task->setInReadyQueue(false);
+            readyCanceled++;
+            updateReadyDepthLocked();
+        }
+    }
     
     // Update the task status in the database
-    dbManager->updateTaskStatus(taskId, TaskStatus::Completed);
+    dbManager->updateTaskStatus(taskId, TaskStatus::Completed, task->getTimeline());
     
-    std::cout << "Canceled task '" << (*taskIt)->getName() << "'" << std::endl;
+    LOG_DEBUG("Canceled task '", task->getName(), "'");
     
     return true;
 }
@@ -295,34 +846,133 @@ bool TaskManager::cancelTask(int taskId) {
 bool TaskManager::pauseTask(int taskId) {
     // This would require more sophisticated task state management
     // For now, just a placeholder
-    std::cout << "Pause functionality not implemented yet" << std::endl;
+    LOG_WARNING("Pause functionality not implemented yet");
     return false;
 }
 
 bool TaskManager::resumeTask(int taskId) {
     // This would require more sophisticated task state management
     // For now, just a placeholder
-    std::cout << "Resume functionality not implemented yet" << std::endl;
+    LOG_WARNING("Resume functionality not implemented yet");
     return false;
 }
 
-// Database statistics methods
+// Statistics methods
 int TaskManager::getTotalTaskCount() const {
-    return dbManager->getTaskCount();
+    return static_cast<int>(counters.getTotal());
 }
 
 int TaskManager::getPendingTaskCount() const {
-    return dbManager->getPendingTaskCount();
+    return static_cast<int>(counters.getCount(TaskStatus::Pending));
 }
 
 int TaskManager::getRunningTaskCount() const {
-    return dbManager->getRunningTaskCount();
+    return static_cast<int>(counters.getCount(TaskStatus::Running));
 }
 
 int TaskManager::getCompletedTaskCount() const {
-    return dbManager->getCompletedTaskCount();
+    return static_cast<int>(counters.getCount(TaskStatus::Completed));
 }
 
 int TaskManager::getTotalNodeCount() const {
-    return dbManager->getNodeCount();
-}
\ No newline at end of file
+    return static_cast<int>(getNodeSnapshot()->size());
+}
+
+void TaskManager::writeMetrics(MetricsWriter& out) const {
+    out.family("taskmaster_tasks", "gauge", "Tasks by status.");
+    const char* statusNames[] = {"pending", "running", "completed"};
+    for (size_t i = 0; i < 3; ++i) {
+        out.sample("taskmaster_tasks", MetricsWriter::label("status", statusNames[i]),
+                   static_cast<double>(counters.getCount(static_cast<TaskStatus>(i))));
+    }
+    
+    out.family("taskmaster_ready_queue_depth", "gauge", "Pending tasks waiting for a node with a free slot.");
+    out.sample("taskmaster_ready_queue_depth", "", static_cast<double>(readyDepth.load()));
+    
+    auto currentNodes = getNodeSnapshot();
+    out.family("taskmaster_node_queue_depth", "gauge", "Tasks queued on a node and not yet started.");
+    for (const auto& node : *currentNodes) {
+        out.sample("taskmaster_node_queue_depth", MetricsWriter::label("node", std::to_string(node->getId())),
+                   static_cast<double>(node->getQueueDepth()));
+    }
+    out.family("taskmaster_node_busy_ratio", "gauge", "Fraction of a node's executor slots running a task.");
+    for (const auto& node : *currentNodes) {
+        out.sample("taskmaster_node_busy_ratio", MetricsWriter::label("node", std::to_string(node->getId())),
+                   static_cast<double>(node->getActiveSlots()) / node->getSlotCount());
+    }
+    out.family("taskmaster_node_task_execution_seconds", "histogram",
+               "Time a node spent running one task (until it finished or yielded). "
+               "The sum is the node's busy time.");
+    for (const auto& node : *currentNodes) {
+        out.histogram("taskmaster_node_task_execution_seconds",
+                      MetricsWriter::label("node", std::to_string(node->getId())),
+                      node->getExecutionTimes().snapshot());
+    }
+    
+    out.family("taskmaster_scheduler_pick_seconds", "histogram",
+               "Time spent in one scheduler call (one task, or one batch from /add_tasks).");
+    pickLatency.forEach([&](const std::string& labels, const LatencyHistogram& histogram) {
+        out.histogram("taskmaster_scheduler_pick_seconds", labels, histogram.snapshot());
+    });
+    
+    out.family("taskmaster_task_stage_seconds", "histogram",
+               "Time finished tasks spent per stage (backlog, node_queue, execution, end_to_end), "
+               "by the scheduler that placed them.");
+    const char* stageNames[] = {"backlog", "node_queue", "execution", "end_to_end"};
+    for (size_t type = 0; type < kSchedulerTypeCount; ++type) {
+        const StageHistograms& stages = stageHistograms[type];
+        if (stages.endToEnd.getCount() == 0) {
+            continue;
+        }
+        const LatencyHistogram* histograms[] = {&stages.backlog, &stages.nodeQueue, &stages.execution,
+                                                &stages.endToEnd};
+        for (size_t stage = 0; stage < 4; ++stage) {
+            out.histogram("taskmaster_task_stage_seconds",
+                          MetricsWriter::label("scheduler", schedulerName(static_cast<SchedulerType>(type))) + "," +
+                          MetricsWriter::label("stage", stageNames[stage]),
+                          histograms[stage]->snapshot());
+        }
+    }
+    
+    out.family("taskmaster_db_commit_seconds", "histogram", "Time to apply and commit one batch of database jobs.");
+    out.histogram("taskmaster_db_commit_seconds", "", dbManager->getCommitTimes().snapshot());
+    out.family("taskmaster_db_write_latency_seconds", "histogram",
+               "Time from queueing a database write to its commit.");
+    out.histogram("taskmaster_db_write_latency_seconds", "", dbManager->getWriteLatencies().snapshot());
+}
+
+void TaskManager::recordStageLatencies(const Task& task) {
+    TaskTimeline timeline = task.getTimeline();
+    if (timeline.started == 0 || task.getSchedulerTag() >= kSchedulerTypeCount) {
+        return;
+    }
+    // Delayed tasks only start waiting for a node at their run_at time. A
+    // task stolen after it was preempted was reassigned after it started.
+    long long ready = std::max(timeline.submitted, task.getRunAt() * 1000);
+    long long assigned = timeline.assigned ? std::min(timeline.assigned, timeline.started) : timeline.started;
+    auto nanosBetween = [](long long from, long long to) {
+        return static_cast<uint64_t>(std::max(0LL, to - from)) * 1000;
+    };
+    StageHistograms& stages = stageHistograms[task.getSchedulerTag()];
+    stages.backlog.record(nanosBetween(ready, assigned));
+    stages.nodeQueue.record(nanosBetween(assigned, timeline.started));
+    stages.execution.record(nanosBetween(timeline.started, timeline.finished));
+    stages.endToEnd.record(nanosBetween(timeline.submitted, timeline.finished));
+}
+
+TaskManager::StageLatencies TaskManager::getStageLatencies(SchedulerType type) const {
+    const StageHistograms& stages = stageHistograms[static_cast<size_t>(type)];
+    return StageLatencies{stages.backlog.snapshot(), stages.nodeQueue.snapshot(),
+                          stages.execution.snapshot(), stages.endToEnd.snapshot()};
+}
+
+const char* TaskManager::schedulerName(SchedulerType type) {
+    switch (type) {
+        case SchedulerType::FIFO: return "FIFO";
+        case SchedulerType::RoundRobin: return "RoundRobin";
+        case SchedulerType::LoadBalanced: return "LoadBalanced";
+        case SchedulerType::PowerOfTwoChoices: return "PowerOfTwoChoices";
+        case SchedulerType::LeastWork: return "LeastWork";
+    }
+    return "FIFO";
+}
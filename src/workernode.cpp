@@ -8,13 +8,13 @@ WorkerNode::WorkerNode(int id, const std::string& name)
 
 void WorkerNode::activate() {
     active = true;
-    LoggingService::getInstance()->info("Worker node '" + nodeName + "' activated");
+    LOG_INFO("Worker node '", nodeName, "' activated");
     notifyObservers("Node activated: " + nodeName);
 }
 
 void WorkerNode::deactivate() {
     active = false;
-    LoggingService::getInstance()->info("Worker node '" + nodeName + "' deactivated");
+    LOG_INFO("Worker node '", nodeName, "' deactivated");
     notifyObservers("Node deactivated: " + nodeName);
 }
 
@@ -24,8 +24,7 @@ bool WorkerNode::isActive() const {
 
 void WorkerNode::addTask(const Task& task) {
     taskQueue.push(std::make_shared<Task>(task));
-    LoggingService::getInstance()->info("Task #" + std::to_string(task.getId()) + 
-                                      " added to node '" + nodeName + "'");
+    LOG_INFO("Task #", task.getId(), " added to node '", nodeName, "'");
     notifyObservers("Task added to node: " + nodeName);
 }
 
@@ -37,8 +36,7 @@ std::shared_ptr<Task> WorkerNode::getNextTask() {
     std::shared_ptr<Task> task = taskQueue.front(); // Get shared_ptr<Task>
     taskQueue.pop();
     
-    LoggingService::getInstance()->info("Processing task #" + std::to_string(task->getId()) + 
-                                      " on node '" + nodeName + "'");
+    LOG_INFO("Processing task #", task->getId(), " on node '", nodeName, "'");
     
     return task;
 }
@@ -54,23 +52,20 @@ int WorkerNode::getQueueSize() const {
 
 void WorkerNode::registerObserver(int observerId) {
     observers.push_back(observerId);
-    LoggingService::getInstance()->debug("Observer #" + std::to_string(observerId) + 
-                                       " registered to node '" + nodeName + "'");
+    LOG_DEBUG("Observer #", observerId, " registered to node '", nodeName, "'");
 }
 
 void WorkerNode::removeObserver(int observerId) {
     auto it = std::find(observers.begin(), observers.end(), observerId);
     if (it != observers.end()) {
         observers.erase(it);
-        LoggingService::getInstance()->debug("Observer #" + std::to_string(observerId) + 
-                                           " removed from node '" + nodeName + "'");
+        LOG_DEBUG("Observer #", observerId, " removed from node '", nodeName, "'");
     }
 }
 
 void WorkerNode::notifyObservers(const std::string& message) {
     // In a real system, this would actually notify the observer objects
-    LoggingService::getInstance()->debug("Notifying " + std::to_string(observers.size()) + 
-                                       " observers: " + message);
+    LOG_DEBUG("Notifying ", observers.size(), " observers: ", message);
 }
 
 int WorkerNode::getId() const {